@@ -0,0 +1,130 @@
+#include "rqm/rqm.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// arrays of mostly small numbers, with the occasional one that needs the heap. the same values are stored as znum and as compact_znum
+template<typename T>
+static std::vector<T> make_array(size_t n)
+{
+    std::mt19937_64 rng(1234);
+    std::vector<T> v;
+    v.reserve(n);
+    for(size_t i = 0; i < n; ++i)
+    {
+        int64_t x = int64_t(rng() % 2000001) - 1000000;
+        if(i % 1024 == 0)
+        {
+            v.emplace_back(rqm::znum(x) << 100);
+        } else
+        {
+            v.emplace_back(x);
+        }
+    }
+    return v;
+}
+
+template<typename T>
+static void sum_array(benchmark::State &state)
+{
+    // Perform setup here
+    std::vector<T> v = make_array<T>(state.range(0));
+    for(auto _: state)
+    {
+        // This code gets timed. a linear walk, so it is bound by memory bandwidth once the array is out of cache
+        T acc = 0;
+        for(const T &x: v)
+        {
+            acc += x;
+        }
+        benchmark::DoNotOptimize(acc);
+    }
+    state.SetItemsProcessed(state.iterations() * v.size());
+    state.SetBytesProcessed(state.iterations() * v.size() * sizeof(T));
+}
+
+template<typename T>
+static void scan_array(benchmark::State &state)
+{
+    // Perform setup here
+    std::vector<T> v = make_array<T>(state.range(0));
+    for(auto _: state)
+    {
+        // This code gets timed. next to no work per element, so this shows the memory traffic of the layout most directly
+        int64_t n_negative = 0;
+        for(const T &x: v)
+        {
+            n_negative += x.signum() < 0;
+        }
+        benchmark::DoNotOptimize(n_negative);
+    }
+    state.SetItemsProcessed(state.iterations() * v.size());
+    state.SetBytesProcessed(state.iterations() * v.size() * sizeof(T));
+}
+
+template<typename T>
+static void gather_array(benchmark::State &state)
+{
+    // Perform setup here
+    std::vector<T> v = make_array<T>(state.range(0));
+    std::vector<uint32_t> indices(1 << 16);
+    std::mt19937 rng(5678);
+    for(uint32_t &idx: indices)
+    {
+        idx = rng() % v.size();
+    }
+    for(auto _: state)
+    {
+        // This code gets timed. random access, so it is bound by cache misses once the array is out of cache
+        T acc = 0;
+        for(uint32_t idx: indices)
+        {
+            acc += v[idx];
+        }
+        benchmark::DoNotOptimize(acc);
+    }
+    state.SetItemsProcessed(state.iterations() * indices.size());
+}
+
+static void RQM_ZNUM_sum_array(benchmark::State &state)
+{
+    sum_array<rqm::znum>(state);
+}
+
+BENCHMARK(RQM_ZNUM_sum_array)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+static void RQM_COMPACT_ZNUM_sum_array(benchmark::State &state)
+{
+    sum_array<rqm::compact_znum>(state);
+}
+
+BENCHMARK(RQM_COMPACT_ZNUM_sum_array)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+static void RQM_ZNUM_scan_array(benchmark::State &state)
+{
+    scan_array<rqm::znum>(state);
+}
+
+BENCHMARK(RQM_ZNUM_scan_array)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+static void RQM_COMPACT_ZNUM_scan_array(benchmark::State &state)
+{
+    scan_array<rqm::compact_znum>(state);
+}
+
+BENCHMARK(RQM_COMPACT_ZNUM_scan_array)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+static void RQM_ZNUM_gather_array(benchmark::State &state)
+{
+    gather_array<rqm::znum>(state);
+}
+
+BENCHMARK(RQM_ZNUM_gather_array)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+static void RQM_COMPACT_ZNUM_gather_array(benchmark::State &state)
+{
+    gather_array<rqm::compact_znum>(state);
+}
+
+BENCHMARK(RQM_COMPACT_ZNUM_gather_array)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
@@ -1,5 +1,6 @@
 #include "rqm/rqm.h"
 #include <benchmark/benchmark.h>
+#include <vector>
 
 static void int64_t_add(benchmark::State &state)
 {
@@ -194,3 +195,277 @@ static void RQM_ZNUM_div_num_with_digit(benchmark::State &state)
 }
 
 BENCHMARK(RQM_ZNUM_div_num_with_digit);
+
+static void add_large(benchmark::State &state, const rqm::digit_allocator &allocator)
+{
+    rqm::set_digit_allocator(allocator);
+    {
+        // Perform setup here
+        rqm::znum a = rqm::znum(0x123456789) << 1000;
+        rqm::znum b = rqm::znum(0x123456789) << 1000;
+
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        for(auto _: state)
+        {
+            // This code gets timed. allocates a fresh result every time
+            rqm::znum c = a + b;
+            benchmark::DoNotOptimize(c);
+        }
+    }
+    rqm::set_digit_allocator(rqm::new_delete_digit_allocator());
+}
+
+static void RQM_ZNUM_add_large_new_delete(benchmark::State &state)
+{
+    add_large(state, rqm::new_delete_digit_allocator());
+}
+
+BENCHMARK(RQM_ZNUM_add_large_new_delete);
+
+static void RQM_ZNUM_add_large_pooled(benchmark::State &state)
+{
+    add_large(state, rqm::pooled_digit_allocator());
+}
+
+BENCHMARK(RQM_ZNUM_add_large_pooled);
+
+static void RQM_ZNUM_mul_then_add(benchmark::State &state)
+{
+    // Perform setup here
+    rqm::znum a = rqm::znum(0x123456789) << 1000;
+    rqm::znum b = rqm::znum(0x123456789) << 500;
+    rqm::znum acc = 0;
+
+    benchmark::DoNotOptimize(a);
+    benchmark::DoNotOptimize(b);
+    for(auto _: state)
+    {
+        // This code gets timed. the product goes through a temporary
+        acc += a * b;
+        benchmark::DoNotOptimize(acc);
+    }
+}
+
+BENCHMARK(RQM_ZNUM_mul_then_add);
+
+static void RQM_ZNUM_addmul(benchmark::State &state)
+{
+    // Perform setup here
+    rqm::znum a = rqm::znum(0x123456789) << 1000;
+    rqm::znum b = rqm::znum(0x123456789) << 500;
+    rqm::znum acc = 0;
+
+    benchmark::DoNotOptimize(a);
+    benchmark::DoNotOptimize(b);
+    for(auto _: state)
+    {
+        // This code gets timed. the product is accumulated in place
+        addmul(acc, a, b);
+        benchmark::DoNotOptimize(acc);
+    }
+}
+
+BENCHMARK(RQM_ZNUM_addmul);
+
+static void RQM_FIXED_ZNUM_mul_512(benchmark::State &state)
+{
+    // Perform setup here
+    rqm::fixed_znum<16> a((rqm::znum(0x123456789) << 200) + 12345);
+    rqm::fixed_znum<16> b((rqm::znum(0x987654321) << 200) + 54321);
+
+    benchmark::DoNotOptimize(a);
+    benchmark::DoNotOptimize(b);
+    for(auto _: state)
+    {
+        // This code gets timed. never allocates, and the loops are of fixed length
+        rqm::fixed_znum<16> c = a * b;
+        benchmark::DoNotOptimize(c);
+    }
+}
+
+BENCHMARK(RQM_FIXED_ZNUM_mul_512);
+
+static void RQM_ZNUM_mul_512(benchmark::State &state)
+{
+    // Perform setup here
+    rqm::znum a = (rqm::znum(0x123456789) << 200) + 12345;
+    rqm::znum b = (rqm::znum(0x987654321) << 200) + 54321;
+
+    benchmark::DoNotOptimize(a);
+    benchmark::DoNotOptimize(b);
+    for(auto _: state)
+    {
+        // This code gets timed
+        rqm::znum c = a * b;
+        benchmark::DoNotOptimize(c);
+    }
+}
+
+BENCHMARK(RQM_ZNUM_mul_512);
+
+static void RQM_ZNUM_to_string_large(benchmark::State &state)
+{
+    // Perform setup here. the argument is the number of decimals
+    rqm::znum a = rqm::znum::from_string(std::string(state.range(0), '7'));
+
+    benchmark::DoNotOptimize(a);
+    for(auto _: state)
+    {
+        // This code gets timed
+        std::string s = rqm::to_string(a);
+        benchmark::DoNotOptimize(s);
+    }
+}
+
+BENCHMARK(RQM_ZNUM_to_string_large)->Arg(1000)->Arg(10000)->Arg(100000);
+
+static void RQM_ZNUM_from_string_large(benchmark::State &state)
+{
+    // Perform setup here. the argument is the number of decimals
+    std::string s(state.range(0), '7');
+
+    benchmark::DoNotOptimize(s);
+    for(auto _: state)
+    {
+        // This code gets timed
+        rqm::znum a = rqm::znum::from_string(s);
+        benchmark::DoNotOptimize(a);
+    }
+}
+
+BENCHMARK(RQM_ZNUM_from_string_large)->Arg(1000)->Arg(10000)->Arg(100000);
+
+static void RQM_ZNUM_to_string(benchmark::State &state)
+{
+    // Perform setup here
+    rqm::znum a = (rqm::znum(0x123456789) << 64) + 0x987654321;
+
+    benchmark::DoNotOptimize(a);
+    for(auto _: state)
+    {
+        // This code gets timed
+        std::string s = rqm::to_string(a);
+        benchmark::DoNotOptimize(s);
+    }
+}
+
+BENCHMARK(RQM_ZNUM_to_string);
+
+static void RQM_ZNUM_from_string(benchmark::State &state)
+{
+    // Perform setup here. a typical id-sized number of 40 decimals
+    std::string s = "-1234567890123456789012345678901234567890";
+
+    benchmark::DoNotOptimize(s);
+    for(auto _: state)
+    {
+        // This code gets timed
+        rqm::znum a = rqm::znum::from_string(s);
+        benchmark::DoNotOptimize(a);
+    }
+}
+
+BENCHMARK(RQM_ZNUM_from_string);
+
+static void RQM_ZNUM_to_string_hex_large(benchmark::State &state)
+{
+    // Perform setup here. the argument is the number of hex characters
+    rqm::znum a = rqm::znum::from_string(std::string(state.range(0), 'b'), 16);
+
+    benchmark::DoNotOptimize(a);
+    for(auto _: state)
+    {
+        // This code gets timed
+        std::string s = rqm::to_string(a, 16);
+        benchmark::DoNotOptimize(s);
+    }
+}
+
+BENCHMARK(RQM_ZNUM_to_string_hex_large)->Arg(1000)->Arg(100000);
+
+static void RQM_ZNUM_serialize_roundtrip(benchmark::State &state)
+{
+    // Perform setup here
+    rqm::znum a = (rqm::znum(0x123456789) << 1000) + 0x987654321;
+    std::vector<std::byte> buf(rqm::serialized_size(a));
+
+    benchmark::DoNotOptimize(a);
+    for(auto _: state)
+    {
+        // This code gets timed
+        rqm::serialize(buf.data(), buf.data() + buf.size(), a);
+        const std::byte *pos = buf.data();
+        rqm::znum b = rqm::znum::deserialize(pos, buf.data() + buf.size());
+        benchmark::DoNotOptimize(b);
+    }
+}
+
+BENCHMARK(RQM_ZNUM_serialize_roundtrip);
+
+static void RQM_ZNUM_pow(benchmark::State &state)
+{
+    // Perform setup here
+    rqm::znum a = rqm::znum::from_string("123456789012345678901234567");
+    uint64_t exp = state.range(0);
+
+    benchmark::DoNotOptimize(a);
+    for(auto _: state)
+    {
+        // This code gets timed
+        rqm::znum p = pow(a, exp);
+        benchmark::DoNotOptimize(p);
+    }
+}
+
+BENCHMARK(RQM_ZNUM_pow)->Arg(100)->Arg(10000);
+
+static void RQM_ZNUM_factorial(benchmark::State &state)
+{
+    // Perform setup here
+    uint32_t n = state.range(0);
+
+    for(auto _: state)
+    {
+        // This code gets timed
+        rqm::znum f = rqm::factorial(n);
+        benchmark::DoNotOptimize(f);
+    }
+}
+
+BENCHMARK(RQM_ZNUM_factorial)->Arg(1000)->Arg(100000);
+
+static void RQM_ZNUM_is_probable_prime(benchmark::State &state)
+{
+    // Perform setup here
+    rqm::znum p = rqm::next_prime(rqm::znum(1) << state.range(0));
+
+    for(auto _: state)
+    {
+        // This code gets timed. a prime goes through all of the tests
+        bool prime = is_probable_prime(p);
+        benchmark::DoNotOptimize(prime);
+    }
+}
+
+BENCHMARK(RQM_ZNUM_is_probable_prime)->Arg(256)->Arg(1024);
+
+static void RQM_ZNUM_remainder_tree(benchmark::State &state)
+{
+    // Perform setup here
+    std::vector<rqm::znum> moduli;
+    for(int32_t idx = 0; idx < state.range(0); ++idx)
+    {
+        moduli.push_back((rqm::znum(idx + 12345) << 44) + 2 * idx + 1);
+    }
+    rqm::znum x = (rqm::znum(7) << 100000) - 12345;
+
+    for(auto _: state)
+    {
+        // This code gets timed
+        std::vector<rqm::znum> remainders = rqm::remainder_tree(x, moduli);
+        benchmark::DoNotOptimize(remainders);
+    }
+}
+
+BENCHMARK(RQM_ZNUM_remainder_tree)->Arg(100)->Arg(4000);
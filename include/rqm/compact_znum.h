@@ -0,0 +1,241 @@
+#ifndef RQM_COMPACT_ZNUM_H
+#define RQM_COMPACT_ZNUM_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <string>
+
+#include "rqm/digit.h"
+#include "rqm/znum.h"
+
+namespace rqm
+{
+
+    struct numview;
+    /**
+       big integer class with a 16 byte footprint, for when there are very many mostly small numbers to store
+
+       The representation is the same as for znum, except that only a 64-bit magnitude fits inline. Larger values go to the heap,
+       with storage from the same digit allocator as znum.
+       The usual arithmetic and comparisons are offered directly, on the same numview kernels. For anything else, convert to a znum.
+    */
+    class compact_znum
+    {
+    public:
+        class empty_with_n_digits
+        {};
+
+        // this class allocates, so we need the rule of five
+        compact_znum()
+            : _n_digits(0),
+              is_stored_inline(true),
+              heap_capacity_log2(0),
+              _signum(0)
+        {}
+
+        ~compact_znum()
+        {
+            if(!stored_inline())
+            {
+                deallocate_digits(u.digits_ptr, heap_capacity_log2);
+            }
+        }
+
+        compact_znum(const compact_znum &o) // copy constructor
+        {
+            _signum = o._signum;
+            digit_t *ptr = setup_storage(o._n_digits);
+            std::memcpy(ptr, o.digits(), _n_digits * sizeof(digit_t));
+        }
+
+        compact_znum(compact_znum &&o) noexcept // move constructor
+        {
+            _signum = o._signum;
+            _n_digits = o._n_digits;
+            is_stored_inline = o.is_stored_inline;
+            heap_capacity_log2 = o.heap_capacity_log2;
+            u = o.u;
+            o._n_digits = 0;
+            o.is_stored_inline = true;
+            o.heap_capacity_log2 = 0;
+            o._signum = 0;
+        }
+
+        compact_znum &operator=(const compact_znum &o) // copy assignment
+        {
+            if(this == &o) return *this;
+            if(o._n_digits > capacity())
+            {
+                return *this = compact_znum(o);
+            }
+            _signum = o._signum;
+            _n_digits = o._n_digits;
+            std::memcpy(mutable_digits(), o.digits(), o._n_digits * sizeof(digit_t));
+            return *this;
+        }
+
+        compact_znum &operator=(compact_znum &&o) noexcept // move assignment
+        {
+            std::swap(_n_digits, o._n_digits);
+            std::swap(is_stored_inline, o.is_stored_inline);
+            std::swap(heap_capacity_log2, o.heap_capacity_log2);
+            std::swap(_signum, o._signum);
+            std::swap(u, o.u);
+            return *this;
+        }
+
+        compact_znum(empty_with_n_digits, uint32_t __n_digits)
+        {
+            setup_storage(__n_digits);
+            _signum = 0;
+        }
+
+        compact_znum(int64_t value);
+        explicit compact_znum(const znum &o);
+        explicit compact_znum(numview o);
+
+        numview to_numview() const;
+        znum to_znum() const;
+
+        void update_signum_n_digits(numview o);
+
+        uint32_t n_digits() const { return _n_digits; }
+        signum_t signum() const { return _signum; }
+
+        // values that fit inline can be operated on with native 64/128-bit arithmetic
+        bool fits_in_double_digit() const { return _n_digits <= n_inline_digits; }
+
+        double_digit_t abs_double_digit() const
+        {
+            const digit_t *ptr = digits();
+            double_digit_t v = 0;
+            if(_n_digits >= 2) v = double_digit_t(ptr[1]) << n_bits_in_digit;
+            if(_n_digits >= 1) v |= ptr[0];
+            return v;
+        }
+
+        static compact_znum from_signum_magnitude(signum_t signum, quad_digit_t magnitude)
+        {
+            if((magnitude >> n_double_digit_bits) != 0) return from_wide_magnitude(signum, magnitude);
+            compact_znum v;
+            double_digit_t lo = double_digit_t(magnitude);
+            v.u.digits_inline[0] = digit_t(lo);
+            v.u.digits_inline[1] = digit_t(lo >> n_bits_in_digit);
+            v._n_digits = (lo >> n_bits_in_digit) != 0 ? 2 : lo != 0 ? 1 : 0;
+            v._signum = v._n_digits == 0 ? 0 : signum;
+            return v;
+        }
+
+        uint32_t capacity() const { return stored_inline() ? n_inline_digits : uint32_t(std::min<uint64_t>(uint64_t(1) << heap_capacity_log2, UINT32_MAX)); }
+
+        compact_znum &operator+=(const compact_znum &o);
+        compact_znum &operator-=(const compact_znum &o);
+        compact_znum &operator*=(const compact_znum &o);
+
+        // flip the sign in place
+        compact_znum &negate()
+        {
+            _signum = -_signum;
+            return *this;
+        }
+
+    private:
+        digit_t *setup_storage(uint32_t __n_digits)
+        {
+            _n_digits = __n_digits;
+            is_stored_inline = __n_digits <= n_inline_digits;
+            heap_capacity_log2 = 0;
+            if(is_stored_inline)
+            {
+                return u.digits_inline;
+            } else
+            {
+                heap_capacity_log2 = capacity_log2_for(__n_digits);
+                return (u.digits_ptr = allocate_digits(heap_capacity_log2));
+            }
+        }
+
+        static uint8_t capacity_log2_for(uint32_t __n_digits) { return __n_digits <= 1 ? 0 : 64 - __builtin_clzll(uint64_t(__n_digits) - 1); }
+        static compact_znum from_wide_magnitude(signum_t signum, quad_digit_t magnitude);
+
+        static digit_t *allocate_digits(uint8_t capacity_log2);
+        static void deallocate_digits(digit_t *ptr, uint8_t capacity_log2);
+
+        static constexpr uint32_t n_inline_digits = 2;
+
+        bool stored_inline() const { return is_stored_inline; }
+        const digit_t *digits() const { return stored_inline() ? u.digits_inline : u.digits_ptr; }
+        digit_t *mutable_digits() { return stored_inline() ? u.digits_inline : u.digits_ptr; }
+
+        uint32_t _n_digits;
+        bool is_stored_inline;
+        uint8_t heap_capacity_log2; // only meaningful when not stored inline
+        int16_t _signum;
+        union
+        {
+            digit_t *digits_ptr;
+            digit_t digits_inline[n_inline_digits];
+        } u;
+    };
+
+    static_assert(sizeof(compact_znum) == 16, "compact_znum is supposed to be 16 bytes");
+
+    compact_znum operator-(const compact_znum &a);
+    compact_znum abs(const compact_znum &a);
+
+    // general out-of-line implementations of the basic operators, used when the inline fast paths below don't apply
+    compact_znum add_general(const compact_znum &a, const compact_znum &b);
+    compact_znum subtract_general(const compact_znum &a, const compact_znum &b);
+    compact_znum multiply_general(const compact_znum &a, const compact_znum &b);
+
+    // fast paths for when both operands are inline, with the same reasoning as for znum
+    static inline compact_znum operator+(const compact_znum &a, const compact_znum &b)
+    {
+        if(a.fits_in_double_digit() && b.fits_in_double_digit())
+        {
+            signed_quad_digit_t v = signed_quad_digit_t(a.signum()) * a.abs_double_digit() + signed_quad_digit_t(b.signum()) * b.abs_double_digit();
+            return compact_znum::from_signum_magnitude(v < 0 ? -1 : 1, v < 0 ? -v : v);
+        }
+        return add_general(a, b);
+    }
+
+    static inline compact_znum operator-(const compact_znum &a, const compact_znum &b)
+    {
+        if(a.fits_in_double_digit() && b.fits_in_double_digit())
+        {
+            signed_quad_digit_t v = signed_quad_digit_t(a.signum()) * a.abs_double_digit() - signed_quad_digit_t(b.signum()) * b.abs_double_digit();
+            return compact_znum::from_signum_magnitude(v < 0 ? -1 : 1, v < 0 ? -v : v);
+        }
+        return subtract_general(a, b);
+    }
+
+    static inline compact_znum operator*(const compact_znum &a, const compact_znum &b)
+    {
+        if(a.fits_in_double_digit() && b.fits_in_double_digit())
+        {
+            return compact_znum::from_signum_magnitude(a.signum() * b.signum(), quad_digit_t(a.abs_double_digit()) * b.abs_double_digit());
+        }
+        return multiply_general(a, b);
+    }
+
+    signum_t compare(const compact_znum &a, const compact_znum &b);
+    bool operator==(const compact_znum &a, const compact_znum &b);
+    bool operator!=(const compact_znum &a, const compact_znum &b);
+    bool operator<(const compact_znum &a, const compact_znum &b);
+    bool operator<=(const compact_znum &a, const compact_znum &b);
+    bool operator>(const compact_znum &a, const compact_znum &b);
+    bool operator>=(const compact_znum &a, const compact_znum &b);
+
+    static inline bool operator!(const compact_znum &a)
+    {
+        return a.signum() == 0;
+    }
+
+    std::ostream &operator<<(std::ostream &os, const compact_znum &a);
+    std::string to_string(const compact_znum &a);
+
+} // namespace rqm
+
+#endif // RQM_COMPACT_ZNUM_H
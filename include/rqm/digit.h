@@ -21,6 +21,10 @@ namespace rqm
     using signed_double_digit_t = int64_t;
     static constexpr uint32_t n_double_digit_bits = sizeof(double_digit_t) * 8;
 
+    // wide enough to hold the full product of two double digits, used by the native-arithmetic fast paths
+    using quad_digit_t = unsigned __int128;
+    using signed_quad_digit_t = __int128;
+
 } // namespace rqm
 
 #endif // RQM_DIGIT_H
@@ -0,0 +1,58 @@
+#ifndef RQM_DIGIT_ALLOCATOR_H
+#define RQM_DIGIT_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "rqm/digit.h"
+
+namespace rqm
+{
+    /**
+       Hooks for allocating the heap storage of numbers.
+
+       Storage always comes in power-of-two sizes, and the size is passed around as the log2 of the number of digits.
+       deallocate is always given the same size class that the block was allocated with.
+
+       The two built-in allocators both get their memory from new[] and return it with delete[], so a block allocated by one can safely be released by the other,
+       and switching between them is fine whenever no other thread is allocating. A custom allocator must only be installed while no heap-allocated numbers are alive.
+    */
+    struct digit_allocator
+    {
+        digit_t *(*allocate)(uint8_t capacity_log2);
+        void (*deallocate)(digit_t *ptr, uint8_t capacity_log2);
+    };
+
+    // plain new[] and delete[]. this is the default
+    digit_allocator new_delete_digit_allocator();
+
+    /**
+       A thread-local pool of free blocks, one free list per power-of-two size class.
+       Blocks are recycled without any locking. A block freed on a different thread than it was allocated on simply joins the free list of the freeing thread.
+       Each size class caches at most max_pooled_bytes_per_size_class bytes, and blocks larger than that are not pooled at all
+    */
+    digit_allocator pooled_digit_allocator();
+
+    static constexpr size_t max_pooled_bytes_per_size_class = 256 * 1024;
+
+    void set_digit_allocator(const digit_allocator &allocator);
+    const digit_allocator &get_digit_allocator();
+
+    // statistics for the pool of the calling thread
+    struct digit_pool_statistics
+    {
+        uint64_t hits;          // allocations served from the pool
+        uint64_t misses;        // allocations that had to go to new[]
+        uint64_t n_cached;      // blocks currently held in the pool
+        uint64_t cached_bytes;  // bytes currently held in the pool
+    };
+
+    digit_pool_statistics get_digit_pool_statistics();
+    void reset_digit_pool_statistics();
+
+    // release all blocks cached by the pool of the calling thread
+    void trim_digit_pool();
+
+} // namespace rqm
+
+#endif // RQM_DIGIT_ALLOCATOR_H
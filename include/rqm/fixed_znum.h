@@ -0,0 +1,227 @@
+#ifndef RQM_FIXED_ZNUM_H
+#define RQM_FIXED_ZNUM_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <stdexcept>
+#include <string>
+
+#include "rqm/digit.h"
+#include "rqm/znum.h"
+
+namespace rqm
+{
+
+    namespace detail
+    {
+        // out-of-line helpers for fixed_znum, on the numview kernels. digits are always zero-padded up to n_limbs
+
+        // copies the magnitude of a into digits and returns its signum. throws std::overflow_error if a needs more than n_limbs digits
+        signum_t fixed_from_znum(digit_t *digits, uint32_t n_limbs, const znum &a);
+        znum fixed_to_znum(signum_t signum, const digit_t *digits, uint32_t n_limbs);
+
+        // truncating division. either of quotient and remainder may be null. throws std::out_of_range on division by zero
+        void fixed_divmod(signum_t *quotient_signum, digit_t *quotient, signum_t *remainder_signum, digit_t *remainder, signum_t a_signum, const digit_t *a, signum_t b_signum,
+                          const digit_t *b, uint32_t n_limbs);
+    } // namespace detail
+
+    /**
+       big integer with a fixed capacity of NLimbs digits, for inner loops where the numbers are known to be bounded
+
+       Storage is always inline and never allocates. The representation is sign-magnitude like znum, with the unused high digits kept at zero,
+       so addition, subtraction and comparison can run over all NLimbs digits in loops of fixed length that the compiler can unroll.
+       A result that doesn't fit throws std::overflow_error.
+    */
+    template<uint32_t NLimbs>
+    class fixed_znum
+    {
+        static_assert(NLimbs > 0, "a fixed_znum needs at least one digit");
+
+    public:
+        static constexpr uint32_t n_limbs = NLimbs;
+
+        constexpr fixed_znum()
+            : _signum(0),
+              _digits{}
+        {}
+
+        constexpr fixed_znum(int64_t value)
+            : _signum(value < 0 ? -1 : value > 0 ? 1 : 0),
+              _digits{}
+        {
+            uint64_t abs_value = value < 0 ? -uint64_t(value) : uint64_t(value);
+            _digits[0] = digit_t(abs_value);
+            abs_value >>= n_bits_in_digit;
+            if(abs_value != 0)
+            {
+                if(NLimbs < 2) throw std::overflow_error("Out of range for a fixed_znum");
+                _digits[NLimbs < 2 ? 0 : 1] = digit_t(abs_value);
+            }
+        }
+
+        explicit fixed_znum(const znum &o)
+            : _digits{}
+        {
+            _signum = detail::fixed_from_znum(_digits, NLimbs, o);
+        }
+
+        znum to_znum() const { return detail::fixed_to_znum(_signum, _digits, NLimbs); }
+
+        constexpr signum_t signum() const { return _signum; }
+        constexpr const digit_t *digits() const { return _digits; }
+
+        constexpr uint32_t n_digits() const
+        {
+            uint32_t n = NLimbs;
+            while(n > 0 && _digits[n - 1] == 0)
+            {
+                --n;
+            }
+            return n;
+        }
+
+        // compares magnitudes only
+        static constexpr signum_t abs_compare(const fixed_znum &a, const fixed_znum &b)
+        {
+            for(uint32_t idx = NLimbs; idx-- > 0;)
+            {
+                if(a._digits[idx] != b._digits[idx]) return a._digits[idx] < b._digits[idx] ? -1 : 1;
+            }
+            return 0;
+        }
+
+        constexpr fixed_znum &operator+=(const fixed_znum &o) { return add_signed(o, o._signum); }
+        constexpr fixed_znum &operator-=(const fixed_znum &o) { return add_signed(o, -o._signum); }
+
+        constexpr fixed_znum &operator*=(const fixed_znum &o)
+        {
+            // the loops stop at the used digits, which are bounded by NLimbs, so short operands don't pay for the full width
+            uint32_t a_digits = n_digits();
+            uint32_t b_digits = o.n_digits();
+            if(a_digits + b_digits > NLimbs + 1) throw std::overflow_error("Out of range for a fixed_znum");
+            digit_t product[2 * NLimbs] = {};
+            for(uint32_t b_idx = 0; b_idx < b_digits; ++b_idx)
+            {
+                double_digit_t carry = 0;
+                for(uint32_t a_idx = 0; a_idx < a_digits; ++a_idx)
+                {
+                    double_digit_t v = double_digit_t(_digits[a_idx]) * o._digits[b_idx] + carry + product[a_idx + b_idx];
+                    product[a_idx + b_idx] = digit_t(v);
+                    carry = v >> n_bits_in_digit;
+                }
+                product[b_idx + a_digits] = digit_t(carry);
+            }
+            for(uint32_t idx = NLimbs; idx < 2 * NLimbs; ++idx)
+            {
+                if(product[idx] != 0) throw std::overflow_error("Out of range for a fixed_znum");
+            }
+            for(uint32_t idx = 0; idx < NLimbs; ++idx)
+            {
+                _digits[idx] = product[idx];
+            }
+            _signum *= o._signum;
+            return *this;
+        }
+
+        fixed_znum &operator/=(const fixed_znum &o)
+        {
+            detail::fixed_divmod(&_signum, _digits, nullptr, nullptr, _signum, _digits, o._signum, o._digits, NLimbs);
+            return *this;
+        }
+
+        fixed_znum &operator%=(const fixed_znum &o)
+        {
+            detail::fixed_divmod(nullptr, nullptr, &_signum, _digits, _signum, _digits, o._signum, o._digits, NLimbs);
+            return *this;
+        }
+
+        // flip the sign in place
+        constexpr fixed_znum &negate()
+        {
+            _signum = -_signum;
+            return *this;
+        }
+
+        // defined as friends so that integer operands convert implicitly
+        friend constexpr signum_t compare(const fixed_znum &a, const fixed_znum &b)
+        {
+            if(a._signum != b._signum) return a._signum < b._signum ? -1 : 1;
+            return a._signum * abs_compare(a, b);
+        }
+
+        friend constexpr bool operator==(const fixed_znum &a, const fixed_znum &b) { return compare(a, b) == 0; }
+        friend constexpr bool operator!=(const fixed_znum &a, const fixed_znum &b) { return compare(a, b) != 0; }
+        friend constexpr bool operator<(const fixed_znum &a, const fixed_znum &b) { return compare(a, b) < 0; }
+        friend constexpr bool operator<=(const fixed_znum &a, const fixed_znum &b) { return compare(a, b) <= 0; }
+        friend constexpr bool operator>(const fixed_znum &a, const fixed_znum &b) { return compare(a, b) > 0; }
+        friend constexpr bool operator>=(const fixed_znum &a, const fixed_znum &b) { return compare(a, b) >= 0; }
+
+        friend constexpr fixed_znum operator+(fixed_znum a, const fixed_znum &b) { return a += b; }
+        friend constexpr fixed_znum operator-(fixed_znum a, const fixed_znum &b) { return a -= b; }
+        friend constexpr fixed_znum operator*(fixed_znum a, const fixed_znum &b) { return a *= b; }
+        friend fixed_znum operator/(fixed_znum a, const fixed_znum &b) { return a /= b; }
+        friend fixed_znum operator%(fixed_znum a, const fixed_znum &b) { return a %= b; }
+        friend constexpr fixed_znum operator-(fixed_znum a) { return a.negate(); }
+        friend constexpr fixed_znum abs(fixed_znum a) { return a._signum < 0 ? a.negate() : a; }
+        friend constexpr bool operator!(const fixed_znum &a) { return a._signum == 0; }
+
+    private:
+        constexpr fixed_znum &add_signed(const fixed_znum &o, signum_t o_signum)
+        {
+            if(o_signum == 0) return *this;
+            if(_signum == 0 || _signum == o_signum)
+            {
+                // same signs, the magnitudes add
+                double_digit_t carry = 0;
+                for(uint32_t idx = 0; idx < NLimbs; ++idx)
+                {
+                    double_digit_t v = double_digit_t(_digits[idx]) + o._digits[idx] + carry;
+                    _digits[idx] = digit_t(v);
+                    carry = v >> n_bits_in_digit;
+                }
+                if(carry != 0) throw std::overflow_error("Out of range for a fixed_znum");
+                _signum = o_signum;
+                return *this;
+            }
+
+            // opposite signs, subtract the smaller magnitude from the larger
+            signum_t cmp = abs_compare(*this, o);
+            if(cmp == 0)
+            {
+                *this = fixed_znum();
+                return *this;
+            }
+            const digit_t *larger = cmp > 0 ? _digits : o._digits;
+            const digit_t *smaller = cmp > 0 ? o._digits : _digits;
+            digit_t borrow = 0;
+            for(uint32_t idx = 0; idx < NLimbs; ++idx)
+            {
+                digit_t l = larger[idx];
+                digit_t s = smaller[idx];
+                digit_t v = l - s - borrow;
+                borrow = (l < s) || (l - s < borrow);
+                _digits[idx] = v;
+            }
+            if(cmp < 0) _signum = o_signum;
+            return *this;
+        }
+
+        signum_t _signum;
+        digit_t _digits[NLimbs];
+    };
+
+    template<uint32_t NLimbs>
+    std::string to_string(const fixed_znum<NLimbs> &a)
+    {
+        return to_string(a.to_znum());
+    }
+
+    template<uint32_t NLimbs>
+    std::ostream &operator<<(std::ostream &os, const fixed_znum<NLimbs> &a)
+    {
+        return os << a.to_znum();
+    }
+
+} // namespace rqm
+
+#endif // RQM_FIXED_ZNUM_H
@@ -0,0 +1,95 @@
+#ifndef RQM_LITERALS_H
+#define RQM_LITERALS_H
+
+#include <cstdint>
+#include <stdexcept>
+
+#include "rqm/digit.h"
+#include "rqm/znum.h"
+
+namespace rqm
+{
+
+    namespace detail
+    {
+        template<uint32_t NCapacity>
+        struct literal_digits
+        {
+            digit_t digits[NCapacity];
+            uint32_t n_digits;
+        };
+
+        // v = v*base + value over the digits in use. the compile-time counterpart of multiply_with_single_digit followed by add_digit
+        template<uint32_t NCapacity>
+        constexpr void literal_multiply_add(literal_digits<NCapacity> &v, digit_t base, digit_t value)
+        {
+            double_digit_t carry = value;
+            for(uint32_t idx = 0; idx < v.n_digits; ++idx)
+            {
+                double_digit_t d = double_digit_t(v.digits[idx]) * base + carry;
+                v.digits[idx] = digit_t(d);
+                carry = d >> n_bits_in_digit;
+            }
+            if(carry != 0) v.digits[v.n_digits++] = digit_t(carry);
+        }
+
+        // parses an integer literal as the compiler hands it over: decimal, hexadecimal with 0x, binary with 0b or octal with a leading 0, with optional ' separators
+        template<uint32_t NCapacity>
+        constexpr literal_digits<NCapacity> parse_literal(const char *chars, uint32_t n_chars)
+        {
+            literal_digits<NCapacity> v{};
+            digit_t base = 10;
+            uint32_t idx = 0;
+            if(n_chars > 2 && chars[0] == '0' && (chars[1] == 'x' || chars[1] == 'X'))
+            {
+                base = 16;
+                idx = 2;
+            } else if(n_chars > 2 && chars[0] == '0' && (chars[1] == 'b' || chars[1] == 'B'))
+            {
+                base = 2;
+                idx = 2;
+            } else if(n_chars > 1 && chars[0] == '0')
+            {
+                base = 8;
+                idx = 1;
+            }
+
+            for(; idx < n_chars; ++idx)
+            {
+                char c = chars[idx];
+                if(c == '\'') continue;
+                digit_t value = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : base;
+                if(value >= base) throw std::invalid_argument("Not a number");
+                literal_multiply_add(v, base, value);
+            }
+            return v;
+        }
+
+        template<char... Chars>
+        struct znum_literal
+        {
+            static constexpr char chars[] = {Chars...};
+            // no base packs more than 4 bits into a character
+            static constexpr uint32_t capacity = sizeof...(Chars) / 8 + 1;
+            static constexpr literal_digits<capacity> value = parse_literal<capacity>(chars, sizeof...(Chars));
+        };
+    } // namespace detail
+
+    namespace literals
+    {
+        /**
+           znum literals, as in 123456789012345678901234567890_z or 0xffff'ffff'ffff'ffff'ffff_z.
+           The digits are worked out at compile time into a static table, so creating the number is just a copy, and malformed literals fail to compile.
+           Values with up to six digits are stored inline, so they don't allocate either.
+        */
+        template<char... Chars>
+        znum operator""_z()
+        {
+            using literal = detail::znum_literal<Chars...>;
+            return znum::from_digits(1, literal::value.digits, literal::value.n_digits);
+        }
+    } // namespace literals
+
+} // namespace rqm
+
+#endif // RQM_LITERALS_H
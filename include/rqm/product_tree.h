@@ -0,0 +1,54 @@
+#ifndef RQM_PRODUCT_TREE_H
+#define RQM_PRODUCT_TREE_H
+
+#include <cstddef>
+#include <vector>
+
+#include "rqm/znum.h"
+
+namespace rqm
+{
+    /**
+       balanced binary tree of products over a list of numbers
+
+       Level 0 holds the numbers themselves, and each node above is the product of its two children, with an odd one out carried up as is.
+       The root is the product of them all, built from multiplications between operands of about the same size, where the fast multiplication pays off.
+       Reducing a number down the tree turns N independent divisions by the leaves into divisions of shrinking numbers by shrinking nodes,
+       so the cost is that of a few multiplications of the root's size per level rather than N times that of the largest division.
+     */
+    class product_tree
+    {
+    public:
+        explicit product_tree(const std::vector<znum> &leaves);
+
+        size_t size() const { return levels.front().size(); }
+        bool empty() const { return size() == 0; }
+
+        // the product of all the leaves. 1 for no leaves
+        const znum &product() const;
+
+        // x % leaf for every leaf, with the same truncating semantics as %. throws std::out_of_range if a leaf is zero
+        std::vector<znum> remainders(const znum &x) const;
+
+        // x % leaf^2 for every leaf, the step batch_gcd needs
+        std::vector<znum> remainders_of_squares(const znum &x) const;
+
+    private:
+        std::vector<znum> reduce_down(const znum &x, bool squares) const;
+
+        std::vector<std::vector<znum>> levels;
+    };
+
+    // x % m for each m in moduli, by remainder trees over runs of the moduli with products about the size of x. throws std::out_of_range if a modulus is zero
+    std::vector<znum> remainder_tree(const znum &x, const std::vector<znum> &moduli);
+
+    /**
+       gcd(n_i, product of all the other n_j) for each of the numbers, by bernstein's batch gcd: P mod n_i^2 for the product P of all of them,
+       down a remainder tree, and then gcd(n_i, (P mod n_i^2)/n_i). finds every number that shares a factor with any other, for the cost of a few
+       products the size of P, where pairwise gcds cost N^2 of them. throws std::out_of_range if a number is zero
+     */
+    std::vector<znum> batch_gcd(const std::vector<znum> &numbers);
+
+} // namespace rqm
+
+#endif // RQM_PRODUCT_TREE_H
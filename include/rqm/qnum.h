@@ -1,6 +1,8 @@
 #ifndef RQM_QNUM_H
 #define RQM_QNUM_H
 
+#include <charconv>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <iosfwd>
@@ -40,6 +42,9 @@ namespace rqm
         qnum(int64_t nom, int64_t denom);
 
         static qnum from_string(const std::string_view sv);
+
+        // reads a number written by serialize at pos, and advances pos past it. throws std::invalid_argument on malformed or truncated input
+        static qnum deserialize(const std::byte *&pos, const std::byte *end);
         static qnum from_double(double value);
 
         static qnum zero() { return qnum(); }
@@ -53,7 +58,33 @@ namespace rqm
 
         uint32_t n_bits() const { return nominator.n_bits() + denominator.n_bits(); }
 
+        // in-place compound assignment. these update the nominator and denominator in place, reusing their storage where possible
+        qnum &operator+=(const qnum &o);
+        qnum &operator-=(const qnum &o);
+        qnum &operator*=(const qnum &o);
+        qnum &operator*=(int32_t o);
+        qnum &operator/=(const qnum &o);
+        qnum &operator/=(int32_t o);
+
+        // flip the sign in place
+        qnum &negate()
+        {
+            nominator.negate();
+            return *this;
+        }
+
+        // raises the nominator and denominator separately. powers of coprime numbers are coprime, so no gcd is needed. negative exponents invert
+        friend qnum pow(const qnum &a, int64_t exp);
+
     private:
+        class already_canonical
+        {};
+
+        qnum(znum nom, znum denom, already_canonical)
+            : nominator(std::move(nom)),
+              denominator(std::move(denom))
+        {}
+
         void canonicalize();
 
         znum nominator = znum::zero();
@@ -61,6 +92,7 @@ namespace rqm
     };
 
     qnum abs(const qnum &a);
+    qnum pow(const qnum &a, int64_t exp);
 
     signum_t compare(const qnum &a, const qnum &b);
     bool operator==(const qnum &a, const qnum &b);
@@ -79,16 +111,73 @@ namespace rqm
     qnum operator/(const qnum &a, int32_t b);
     qnum operator/(const qnum &a, const qnum &b);
 
-    // simple inline implementations of the pre/post increment/decrement operators. could be optimised further if necessary
+    // overloads for temporary operands, which reuse the nominator and denominator of the temporary for the result
+    static inline qnum operator-(qnum &&a)
+    {
+        return std::move(a.negate());
+    }
+    static inline qnum operator+(qnum &&a, const qnum &b)
+    {
+        return std::move(a += b);
+    }
+    static inline qnum operator+(const qnum &a, qnum &&b)
+    {
+        return std::move(b += a);
+    }
+    static inline qnum operator+(qnum &&a, qnum &&b)
+    {
+        return std::move(a += b);
+    }
+    static inline qnum operator-(qnum &&a, const qnum &b)
+    {
+        return std::move(a -= b);
+    }
+    static inline qnum operator-(const qnum &a, qnum &&b)
+    {
+        // a - b = -(b - a)
+        return std::move((b -= a).negate());
+    }
+    static inline qnum operator-(qnum &&a, qnum &&b)
+    {
+        return std::move(a -= b);
+    }
+    static inline qnum operator*(qnum &&a, const qnum &b)
+    {
+        return std::move(a *= b);
+    }
+    static inline qnum operator*(const qnum &a, qnum &&b)
+    {
+        return std::move(b *= a);
+    }
+    static inline qnum operator*(qnum &&a, qnum &&b)
+    {
+        return std::move(a *= b);
+    }
+    static inline qnum operator*(qnum &&a, int32_t b)
+    {
+        return std::move(a *= b);
+    }
+    static inline qnum operator*(int32_t a, qnum &&b)
+    {
+        return std::move(b *= a);
+    }
+    static inline qnum operator/(qnum &&a, const qnum &b)
+    {
+        return std::move(a /= b);
+    }
+    static inline qnum operator/(qnum &&a, int32_t b)
+    {
+        return std::move(a /= b);
+    }
+
+    // simple inline implementations of the pre/post increment/decrement operators, in terms of the in-place compound operators
     static inline qnum &operator++(qnum &a)
     {
-        a = a + 1;
-        return a;
+        return a += 1;
     }
     static inline qnum &operator--(qnum &a)
     {
-        a = a - 1;
-        return a;
+        return a -= 1;
     }
     static inline qnum operator++(qnum &a, int)
     {
@@ -109,7 +198,21 @@ namespace rqm
     }
 
     std::ostream &operator<<(std::ostream &os, const qnum &a);
+
+    // reads a nominator, optionally followed by a slash and a denominator, with no whitespace in between.
+    // sets failbit and leaves a unchanged if that fails or the denominator is zero
+    std::istream &operator>>(std::istream &is, qnum &a);
     std::string to_string(const qnum &a);
+
+    // the most characters to_chars can write for a, for sizing buffers
+    uint32_t to_chars_max_size(const qnum &a);
+
+    // writes a as nominator/denominator to [first, last) without allocating, like std::to_chars. if it doesn't fit, returns last and std::errc::value_too_large
+    std::to_chars_result to_chars(char *first, char *last, const qnum &a);
+
+    // the compact binary format: the nominator followed by the denominator, each as for znum
+    size_t serialized_size(const qnum &a);
+    std::byte *serialize(std::byte *first, std::byte *last, const qnum &a);
     double to_double(const qnum &a);
 
 } // namespace rqm
@@ -1,7 +1,14 @@
 #ifndef RQM_RQM_H
 #define RQM_RQM_H
 
+#include "rqm/compact_znum.h"
+#include "rqm/digit_allocator.h"
+#include "rqm/fixed_znum.h"
+#include "rqm/literals.h"
+#include "rqm/product_tree.h"
 #include "rqm/znum.h"
+#include "rqm/znum_array.h"
+#include "rqm/znum_view.h"
 
 namespace rqm
 {}
@@ -1,12 +1,16 @@
 #ifndef RQM_ZNUM_H
 #define RQM_ZNUM_H
 
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
 #include <cstdint>
 #include <cstring>
 #include <iosfwd>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include "rqm/digit.h"
 namespace rqm
@@ -26,10 +30,12 @@ namespace rqm
         {};
 
         // this class allocates, so we need the rule of five
-        znum()
+        constexpr znum()
             : _n_digits(0),
               is_stored_inline(true),
-              _signum(0)
+              heap_capacity_log2(0),
+              _signum(0),
+              u{}
         {}
 
         ~znum()
@@ -37,7 +43,7 @@ namespace rqm
         {
             if(!stored_inline())
             {
-                delete[] u.digits_ptr;
+                deallocate_digits(u.digits_ptr, heap_capacity_log2);
             }
         }
 
@@ -54,7 +60,7 @@ namespace rqm
         {
             znum v = znum(empty_with_n_digits(), 1);
             v.u.digits_inline[0] = 1;
-            v._signum = 1;
+            v._signum = -1;
             return v;
         }
 
@@ -81,37 +87,49 @@ namespace rqm
                 std::memcpy(ptr, o.u.digits_inline, _n_digits * sizeof(digit_t));
             } else
             {
-
                 _n_digits = o._n_digits;
-                u.digits_ptr = std::exchange(o.u.digits_ptr, nullptr);
+                heap_capacity_log2 = o.heap_capacity_log2;
+                u.digits_ptr = o.u.digits_ptr;
+
+                // leave o as a valid zero
+                o._n_digits = 0;
+                o.is_stored_inline = true;
+                o._signum = 0;
             }
         }
 
         znum &operator=(const znum &o) // copy assignment
         {
-            return *this = znum(o);
+            if(&o != this)
+            {
+                if(o._n_digits > capacity()) return *this = znum(o);
+
+                // fits in what we already have, so no need to reallocate
+                std::memcpy(mutable_digits(), o.digits(), o._n_digits * sizeof(digit_t));
+                _n_digits = o._n_digits;
+                _signum = o._signum;
+            }
+            return *this;
         }
 
         znum &operator=(znum &&o) noexcept // move assignment
         {
             if(&o != this)
             {
-                _signum = o._signum;
-                if(!stored_inline())
-                {
-                    delete[] u.digits_ptr; // deallocate
-                }
-                u.digits_ptr = nullptr;
-
-                is_stored_inline = o.stored_inline();
-                if(is_stored_inline)
+                if(o.stored_inline())
                 {
+                    // a handful of digits. copy them over and keep our own storage, and with it our capacity. we always have room for the inline digits
+                    std::memcpy(mutable_digits(), o.u.digits_inline, o._n_digits * sizeof(digit_t));
                     _n_digits = o._n_digits;
-                    std::memcpy(u.digits_inline, o.u.digits_inline, _n_digits * sizeof(digit_t));
+                    _signum = o._signum;
                 } else
                 {
+                    // take over the heap storage of o, and hand it ours to dispose of
                     std::swap(_n_digits, o._n_digits);
-                    std::swap(u.digits_ptr, o.u.digits_ptr);
+                    std::swap(is_stored_inline, o.is_stored_inline);
+                    std::swap(heap_capacity_log2, o.heap_capacity_log2);
+                    std::swap(_signum, o._signum);
+                    std::swap(u, o.u);
                 }
             }
             return *this;
@@ -121,7 +139,17 @@ namespace rqm
 
         numview to_numview() const;
 
-        znum(int64_t value);
+        // constexpr, so that numbers with static storage duration initialised from an integer are constant-initialised rather than set up at startup
+        constexpr znum(int64_t value)
+            : _n_digits(n_digits_for(abs_of(value))),
+              is_stored_inline(true),
+              heap_capacity_log2(0),
+              _signum(value < 0 ? -1 : value > 0 ? 1 : 0),
+              u{{digit_t(abs_of(value)), digit_t(abs_of(value) >> n_bits_in_digit)}}
+        {}
+
+        // a number from its digits, least significant first. the most significant digit must be non-zero
+        static znum from_digits(signum_t signum, const digit_t *digits, uint32_t n_digits);
         int64_t to_int64_t() const;
 
         uint32_t n_digits() const { return _n_digits; }
@@ -130,41 +158,139 @@ namespace rqm
 
         void update_signum_n_digits(numview o);
 
+        // take on the value of o, copying it into our own storage if it is large enough
+        void assign(numview o);
+
         signum_t signum() const { return _signum; }
 
-        static znum from_string(const std::string_view sv);
+        // parses an optional minus sign followed by characters in the given base, from 2 to 36, with letters of either case above 9
+        static znum from_string(const std::string_view sv, uint32_t base = 10);
+
+        // reads a number written by serialize at pos, and advances pos past it. throws std::invalid_argument on malformed or truncated input
+        static znum deserialize(const std::byte *&pos, const std::byte *end);
+
+        // in-place compound assignment. these write the result into the existing storage when it is large enough to hold it
+        znum &operator+=(const znum &o);
+        znum &operator-=(const znum &o);
+        znum &operator*=(const znum &o);
+        znum &operator*=(int32_t o);
+        znum &operator/=(const znum &o);
+        znum &operator/=(int32_t o);
+        znum &operator%=(const znum &o);
+        znum &operator%=(int32_t o);
+        znum &operator<<=(uint32_t o);
+        znum &operator>>=(uint32_t o);
+        znum &operator&=(const znum &o);
+        znum &operator|=(const znum &o);
+        znum &operator^=(const znum &o);
+
+        // set or clear one bit of the two's complement form, like |= and &= ~ with a single bit, in place
+        znum &set_bit(uint32_t bit);
+        znum &clear_bit(uint32_t bit);
+
+        // fused multiply-accumulate, the product is accumulated straight into our digits without being materialised as a separate number
+        friend void addmul(znum &acc, const znum &a, const znum &b);
+        friend void submul(znum &acc, const znum &a, const znum &b);
+        friend void addmul_ui(znum &acc, const znum &a, uint64_t b);
+        friend void submul_ui(znum &acc, const znum &a, uint64_t b);
+
+        // flip the sign in place
+        znum &negate()
+        {
+            _signum = -_signum;
+            return *this;
+        }
 
         bool is_one() const { return _signum == 1 && _n_digits == 1 && digits()[0] == 1; }
 
+        // the number of digits we can hold without reallocating. heap storage is allocated in powers of two, so there is usually some room to grow
+        uint32_t capacity() const { return stored_inline() ? n_inline_digits : uint32_t(std::min<uint64_t>(uint64_t(1) << heap_capacity_log2, UINT32_MAX)); }
+
+        // make room for at least n_digits digits, so that results up to that size can be written in place without reallocating
+        void reserve(uint32_t n_digits);
+
+        // release any storage beyond what the current value needs
+        void shrink_to_fit();
+
+        // values with at most two digits can be operated on with native 64/128-bit arithmetic, which the inline fast paths of the operators rely on
+        bool fits_in_double_digit() const { return _n_digits <= 2; }
+
+        double_digit_t abs_double_digit() const
+        {
+            const digit_t *ptr = digits();
+            double_digit_t v = 0;
+            if(_n_digits >= 2) v = double_digit_t(ptr[1]) << n_bits_in_digit;
+            if(_n_digits >= 1) v |= ptr[0];
+            return v;
+        }
+
+        static znum from_signum_magnitude(signum_t signum, quad_digit_t magnitude)
+        {
+            znum v;
+            double_digit_t lo = double_digit_t(magnitude);
+            double_digit_t hi = double_digit_t(magnitude >> n_double_digit_bits);
+            v.u.digits_inline[0] = digit_t(lo);
+            v.u.digits_inline[1] = digit_t(lo >> n_bits_in_digit);
+            v.u.digits_inline[2] = digit_t(hi);
+            v.u.digits_inline[3] = digit_t(hi >> n_bits_in_digit);
+            if(hi != 0)
+            {
+                v._n_digits = (hi >> n_bits_in_digit) != 0 ? 4 : 3;
+            } else
+            {
+                v._n_digits = (lo >> n_bits_in_digit) != 0 ? 2 : lo != 0 ? 1 : 0;
+            }
+            v._signum = v._n_digits == 0 ? 0 : signum;
+            return v;
+        }
+
     private:
+        void multiply_accumulate(numview a, numview b);
+
         uint32_t *setup_storage(size_t __n_digits)
         {
             _n_digits = __n_digits;
             is_stored_inline = __n_digits <= n_inline_digits;
+            heap_capacity_log2 = 0;
             if(is_stored_inline)
             {
                 return u.digits_inline;
             } else
             {
-                return (u.digits_ptr = new digit_t[__n_digits]);
+                heap_capacity_log2 = capacity_log2_for(__n_digits);
+                return (u.digits_ptr = allocate_digits(heap_capacity_log2));
             }
         }
 
+        // heap storage comes in power-of-two sizes, which lets the capacity be stored as a single byte
+        static uint8_t capacity_log2_for(size_t __n_digits) { return __n_digits <= 1 ? 0 : 64 - __builtin_clzll(uint64_t(__n_digits) - 1); }
+        // these go through the allocator installed with set_digit_allocator
+        static digit_t *allocate_digits(uint8_t capacity_log2);
+        static void deallocate_digits(digit_t *ptr, uint8_t capacity_log2);
+
         static constexpr uint32_t n_inline_digits = 6;
 
         bool stored_inline() const { return is_stored_inline; }
         const digit_t *digits() const { return stored_inline() ? u.digits_inline : u.digits_ptr; }
+        digit_t *mutable_digits() { return stored_inline() ? u.digits_inline : u.digits_ptr; }
+
+        static constexpr double_digit_t abs_of(int64_t value) { return value < 0 ? -double_digit_t(value) : double_digit_t(value); }
+        static constexpr uint32_t n_digits_for(double_digit_t magnitude) { return (magnitude >> n_bits_in_digit) != 0 ? 2 : magnitude != 0 ? 1 : 0; }
+
 
         uint32_t _n_digits;
         bool is_stored_inline;
+        uint8_t heap_capacity_log2; // only meaningful when not stored inline. fits in what used to be padding
         int16_t _signum;
         union
         {
+            digit_t digits_inline[n_inline_digits]; // first, so that the constexpr constructors can initialise it
             digit_t *digits_ptr;
-            digit_t digits_inline[n_inline_digits];
         } u;
     };
 
+    static_assert(sizeof(znum) == 32, "keeping track of the capacity should not make the number any larger");
+
     znum abs(const znum &a);
 
     signum_t compare(const znum &a, const znum &b);
@@ -176,9 +302,42 @@ namespace rqm
     bool operator>=(const znum &a, const znum &b);
 
     znum operator-(const znum &a);
-    znum operator+(const znum &a, const znum &b);
-    znum operator-(const znum &a, const znum &b);
-    znum operator*(const znum &a, const znum &b);
+
+    // general out-of-line implementations of the basic operators, used when the inline fast paths below don't apply
+    znum add_general(const znum &a, const znum &b);
+    znum subtract_general(const znum &a, const znum &b);
+    znum multiply_general(const znum &a, const znum &b);
+
+    // fast paths for when both operands fit in a double digit. the sum of two such values needs at most 65 bits and the product at most 128, so the native arithmetic can't overflow
+    static inline znum operator+(const znum &a, const znum &b)
+    {
+        if(a.fits_in_double_digit() && b.fits_in_double_digit())
+        {
+            signed_quad_digit_t v = signed_quad_digit_t(a.signum()) * a.abs_double_digit() + signed_quad_digit_t(b.signum()) * b.abs_double_digit();
+            return znum::from_signum_magnitude(v < 0 ? -1 : 1, v < 0 ? -v : v);
+        }
+        return add_general(a, b);
+    }
+
+    static inline znum operator-(const znum &a, const znum &b)
+    {
+        if(a.fits_in_double_digit() && b.fits_in_double_digit())
+        {
+            signed_quad_digit_t v = signed_quad_digit_t(a.signum()) * a.abs_double_digit() - signed_quad_digit_t(b.signum()) * b.abs_double_digit();
+            return znum::from_signum_magnitude(v < 0 ? -1 : 1, v < 0 ? -v : v);
+        }
+        return subtract_general(a, b);
+    }
+
+    static inline znum operator*(const znum &a, const znum &b)
+    {
+        if(a.fits_in_double_digit() && b.fits_in_double_digit())
+        {
+            return znum::from_signum_magnitude(a.signum() * b.signum(), quad_digit_t(a.abs_double_digit()) * b.abs_double_digit());
+        }
+        return multiply_general(a, b);
+    }
+
     znum operator*(const znum &a, int32_t b);
     znum operator*(int32_t a, const znum &b);
     znum operator/(const znum &a, int32_t b);
@@ -188,16 +347,202 @@ namespace rqm
     znum operator<<(const znum &a, uint32_t b);
     znum operator>>(const znum &a, uint32_t b);
 
-    // simple inline implementations of the pre/post increment/decrement operators. could be optimised further if necessary
+    /*
+      bitwise operators see the numbers as two's complement with infinite sign extension, so that they agree with >>, which floors.
+      ~a is -a - 1, and a negative result of &, | or ^ is returned in the usual sign-magnitude form
+     */
+    znum bitwise_and_general(const znum &a, const znum &b);
+    znum bitwise_or_general(const znum &a, const znum &b);
+    znum bitwise_xor_general(const znum &a, const znum &b);
+
+    // fast paths for when both operands fit in a double digit, where native signed arithmetic is two's complement already
+    static inline znum operator&(const znum &a, const znum &b)
+    {
+        if(a.fits_in_double_digit() && b.fits_in_double_digit())
+        {
+            signed_quad_digit_t v = (signed_quad_digit_t(a.signum()) * a.abs_double_digit()) & (signed_quad_digit_t(b.signum()) * b.abs_double_digit());
+            return znum::from_signum_magnitude(v < 0 ? -1 : 1, v < 0 ? -v : v);
+        }
+        return bitwise_and_general(a, b);
+    }
+
+    static inline znum operator|(const znum &a, const znum &b)
+    {
+        if(a.fits_in_double_digit() && b.fits_in_double_digit())
+        {
+            signed_quad_digit_t v = (signed_quad_digit_t(a.signum()) * a.abs_double_digit()) | (signed_quad_digit_t(b.signum()) * b.abs_double_digit());
+            return znum::from_signum_magnitude(v < 0 ? -1 : 1, v < 0 ? -v : v);
+        }
+        return bitwise_or_general(a, b);
+    }
+
+    static inline znum operator^(const znum &a, const znum &b)
+    {
+        if(a.fits_in_double_digit() && b.fits_in_double_digit())
+        {
+            signed_quad_digit_t v = (signed_quad_digit_t(a.signum()) * a.abs_double_digit()) ^ (signed_quad_digit_t(b.signum()) * b.abs_double_digit());
+            return znum::from_signum_magnitude(v < 0 ? -1 : 1, v < 0 ? -v : v);
+        }
+        return bitwise_xor_general(a, b);
+    }
+
+    static inline znum operator~(const znum &a)
+    {
+        return -a - 1;
+    }
+
+    bool test_bit(const znum &a, uint32_t bit);
+
+    // the number of set bits. negative numbers have infinitely many, and give UINT64_MAX
+    uint64_t popcount(const znum &a);
+
+    // the number of bits where a and b differ. UINT64_MAX when exactly one of them is negative
+    uint64_t hamming_distance(const znum &a, const znum &b);
+
+    // quotient and remainder from a single division. these truncate like / and %, so the remainder takes the sign of the dividend
+    std::pair<znum, znum> divmod(const znum &a, const znum &b);
+    std::pair<znum, int32_t> divmod(const znum &a, int32_t b);
+
+    /*
+      division writing the quotient and remainder into q and r, reusing their storage. q and r must be different objects, but either may be a or b.
+      tdiv_qr truncates towards zero, so the remainder takes the sign of a.
+      fdiv_qr rounds the quotient towards negative infinity, so the remainder takes the sign of b.
+      cdiv_qr rounds the quotient towards positive infinity, so the remainder takes the opposite sign of b.
+     */
+    void tdiv_qr(znum &q, znum &r, const znum &a, const znum &b);
+    void fdiv_qr(znum &q, znum &r, const znum &a, const znum &b);
+    void cdiv_qr(znum &q, znum &r, const znum &a, const znum &b);
+    void tdiv_qr(znum &q, int32_t &r, const znum &a, int32_t b);
+    void fdiv_qr(znum &q, int32_t &r, const znum &a, int32_t b);
+    void cdiv_qr(znum &q, int32_t &r, const znum &a, int32_t b);
+
+    /*
+      overloads for temporary operands. these compute the result in place in the storage of the temporary, so expressions like a*b + c*d - e
+      only allocate for the intermediates that can't reuse anything. the int32_t variants are needed to keep e.g. (a + b) * 2 unambiguous
+    */
+    static inline znum operator-(znum &&a)
+    {
+        return std::move(a.negate());
+    }
+    static inline znum operator+(znum &&a, const znum &b)
+    {
+        return std::move(a += b);
+    }
+    static inline znum operator+(const znum &a, znum &&b)
+    {
+        return std::move(b += a);
+    }
+    static inline znum operator+(znum &&a, znum &&b)
+    {
+        return std::move(a += b);
+    }
+    static inline znum operator-(znum &&a, const znum &b)
+    {
+        return std::move(a -= b);
+    }
+    static inline znum operator-(const znum &a, znum &&b)
+    {
+        // a - b = -(b - a)
+        return std::move((b -= a).negate());
+    }
+    static inline znum operator-(znum &&a, znum &&b)
+    {
+        return std::move(a -= b);
+    }
+    static inline znum operator*(znum &&a, const znum &b)
+    {
+        return std::move(a *= b);
+    }
+    static inline znum operator*(const znum &a, znum &&b)
+    {
+        return std::move(b *= a);
+    }
+    static inline znum operator*(znum &&a, znum &&b)
+    {
+        return std::move(a *= b);
+    }
+    static inline znum operator*(znum &&a, int32_t b)
+    {
+        return std::move(a *= b);
+    }
+    static inline znum operator*(int32_t a, znum &&b)
+    {
+        return std::move(b *= a);
+    }
+    static inline znum operator/(znum &&a, const znum &b)
+    {
+        return std::move(a /= b);
+    }
+    static inline znum operator/(znum &&a, int32_t b)
+    {
+        return std::move(a /= b);
+    }
+    static inline znum operator%(znum &&a, const znum &b)
+    {
+        return std::move(a %= b);
+    }
+    static inline int32_t operator%(znum &&a, int32_t b)
+    {
+        return static_cast<const znum &>(a) % b;
+    }
+    static inline znum operator&(znum &&a, const znum &b)
+    {
+        return std::move(a &= b);
+    }
+    static inline znum operator&(const znum &a, znum &&b)
+    {
+        return std::move(b &= a);
+    }
+    static inline znum operator&(znum &&a, znum &&b)
+    {
+        return std::move(a &= b);
+    }
+    static inline znum operator|(znum &&a, const znum &b)
+    {
+        return std::move(a |= b);
+    }
+    static inline znum operator|(const znum &a, znum &&b)
+    {
+        return std::move(b |= a);
+    }
+    static inline znum operator|(znum &&a, znum &&b)
+    {
+        return std::move(a |= b);
+    }
+    static inline znum operator^(znum &&a, const znum &b)
+    {
+        return std::move(a ^= b);
+    }
+    static inline znum operator^(const znum &a, znum &&b)
+    {
+        return std::move(b ^= a);
+    }
+    static inline znum operator^(znum &&a, znum &&b)
+    {
+        return std::move(a ^= b);
+    }
+    static inline znum operator~(znum &&a)
+    {
+        // -a - 1 = -(a + 1)
+        return std::move((a += 1).negate());
+    }
+    static inline znum operator<<(znum &&a, uint32_t b)
+    {
+        return std::move(a <<= b);
+    }
+    static inline znum operator>>(znum &&a, uint32_t b)
+    {
+        return std::move(a >>= b);
+    }
+
+    // simple inline implementations of the pre/post increment/decrement operators, in terms of the in-place compound operators
     static inline znum &operator++(znum &a)
     {
-        a = a + 1;
-        return a;
+        return a += 1;
     }
     static inline znum &operator--(znum &a)
     {
-        a = a - 1;
-        return a;
+        return a -= 1;
     }
     static inline znum operator++(znum &a, int)
     {
@@ -217,11 +562,62 @@ namespace rqm
         return a.signum() == 0;
     }
 
+    // acc += a*b and acc -= a*b, without a temporary for the product
+    void addmul(znum &acc, const znum &a, const znum &b);
+    void submul(znum &acc, const znum &a, const znum &b);
+    void addmul_ui(znum &acc, const znum &a, uint64_t b);
+    void submul_ui(znum &acc, const znum &a, uint64_t b);
+
+    // large numbers are written as they are formatted, in bounded-size pieces, unless a field width is set
     std::ostream &operator<<(std::ostream &os, const znum &a);
-    std::string to_string(const znum &a);
+
+    // reads an optional minus sign and decimal digits, a block at a time, without holding all of the text.
+    // sets failbit and leaves a unchanged if there are no digits
+    std::istream &operator>>(std::istream &is, znum &a);
+
+    // bases from 2 to 36 are supported, with lowercase letters above 9. powers of two take linear time
+    std::string to_string(const znum &a, uint32_t base = 10);
+
+    // the most characters to_chars can write for a, for sizing buffers
+    uint32_t to_chars_max_size(const znum &a, uint32_t base = 10);
+
+    // writes a to [first, last) without allocating, like std::to_chars. if it doesn't fit, returns last and std::errc::value_too_large
+    std::to_chars_result to_chars(char *first, char *last, const znum &a, uint32_t base = 10);
+
+    // the compact binary format: a varint header with the sign, the number of digits and a format version, followed by the digits in little-endian order.
+    // serialize writes a to [first, last) and returns the end of what it wrote. throws std::length_error if there's less room than serialized_size(a)
+    size_t serialized_size(const znum &a);
+    std::byte *serialize(std::byte *first, std::byte *last, const znum &a);
 
     uint32_t countr_zero(const znum &v);
 
+    // a^exp by binary exponentiation, squaring and multiplying between two buffers sized for the result up front. pow(a, 0) is 1, also for a = 0
+    znum pow(const znum &a, uint64_t exp);
+
+    // the integer square root, floor(sqrt(a)), and with it the remainder a - floor(sqrt(a))^2. throw std::domain_error for negative a
+    znum isqrt(const znum &a);
+    std::pair<znum, znum> sqrtrem(const znum &a);
+
+    // the k-th root, truncated towards zero. odd roots of negative numbers are negative, and even ones throw std::domain_error
+    znum iroot(const znum &a, uint32_t k);
+
+    // whether a = m^2, and whether a = m^k for some k >= 2. 0 and 1 count as both, and -1 as a cube
+    bool is_perfect_square(const znum &a);
+    bool is_perfect_power(const znum &a);
+
+    // n!, n choose k, and (k1 + k2 + ...)!/(k1! k2! ...). all three are built from the prime factorisation, sieved up to n,
+    // multiplied up in a balanced product tree. factorial uses the prime swing recursion, n! = (floor(n/2)!)^2 * swing(n). binomial is 0 for k > n
+    znum factorial(uint32_t n);
+    znum binomial(uint32_t n, uint32_t k);
+    znum multinomial(const std::vector<uint32_t> &ks);
+
+    // the baillie-psw test: trial division by the primes below 1024, in one pass over the digits, then a strong fermat test to base 2 and a strong lucas test,
+    // in montgomery arithmetic. no composite is known to pass it. rounds adds strong fermat tests to the odd prime bases 3, 5, 7, ... on top
+    bool is_probable_prime(const znum &n, uint32_t rounds = 0);
+
+    // the smallest probable prime larger than a
+    znum next_prime(const znum &a);
+
     znum gcd(const znum &a, const znum &b);
 
 } // namespace rqm
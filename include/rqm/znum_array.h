@@ -0,0 +1,85 @@
+#ifndef RQM_ZNUM_ARRAY_H
+#define RQM_ZNUM_ARRAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include "rqm/znum.h"
+#include "rqm/znum_view.h"
+
+namespace rqm
+{
+    /**
+       read-only array of big integers, laid out so that they can be used straight from a memory-mapped file
+
+       The layout is a 16-byte header (the magic "rqmZarr", a version byte, and the count as a little-endian uint64),
+       then count+1 little-endian uint64 index entries of digit_offset << 2 | sign, and then the pool of little-endian 32-bit digits.
+       Number i has its digits at [offset(i), offset(i+1)) of the pool, so every element is reached in O(1),
+       and its digits are aligned, so that the elements come out as znum_views without being copied or parsed.
+       Sign codes are 0 for zero or positive, and 1 for negative.
+     */
+    class znum_array_view
+    {
+    public:
+        constexpr znum_array_view()
+            : n_elements(0),
+              index(nullptr),
+              pool(nullptr),
+              n_pool_digits(0)
+        {}
+
+        // checks the header and the bounds of the index and the pool. the data must be 8-byte aligned and outlive the view
+        znum_array_view(const std::byte *data, size_t size);
+
+        size_t size() const { return n_elements; }
+        bool empty() const { return n_elements == 0; }
+
+        // bounds-checked, and checks the element against the pool, so a corrupt file throws rather than reads out of bounds
+        znum_view operator[](size_t idx) const;
+
+    private:
+        size_t n_elements;
+        const uint64_t *index;
+        const digit_t *pool;
+        uint64_t n_pool_digits;
+    };
+
+    /**
+       a znum_array file, mapped into memory. moving the mapping keeps views into it valid
+     */
+    class mapped_znum_array
+    {
+    public:
+        explicit mapped_znum_array(const std::string &path);
+        ~mapped_znum_array();
+
+        mapped_znum_array(const mapped_znum_array &) = delete;
+        mapped_znum_array &operator=(const mapped_znum_array &) = delete;
+        mapped_znum_array(mapped_znum_array &&o) noexcept;
+        mapped_znum_array &operator=(mapped_znum_array &&o) noexcept;
+
+        size_t size() const { return array.size(); }
+        bool empty() const { return array.empty(); }
+        znum_view operator[](size_t idx) const { return array[idx]; }
+        const znum_array_view &view() const { return array; }
+
+    private:
+        void release();
+
+        void *mapping = nullptr;
+        size_t mapping_size = 0;
+        znum_array_view array;
+    };
+
+    // the number of bytes write_znum_array produces
+    size_t znum_array_size(const std::vector<znum> &numbers);
+
+    // writes the numbers in the znum_array layout
+    void write_znum_array(std::ostream &os, const std::vector<znum> &numbers);
+
+} // namespace rqm
+
+#endif // RQM_ZNUM_ARRAY_H
@@ -0,0 +1,98 @@
+#ifndef RQM_ZNUM_VIEW_H
+#define RQM_ZNUM_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+
+#include "rqm/digit.h"
+#include "rqm/znum.h"
+
+namespace rqm
+{
+
+    struct numview;
+    /**
+       read-only, non-owning view of a big integer
+
+       The public counterpart of the views the arithmetic kernels work on: a sign, and digits stored elsewhere, least significant first,
+       with the most significant one non-zero. The storage has to outlive the view.
+       Views come from znums, from a znum_array or from any other digits in memory, and the const operations below work on them in place,
+       without copying the digits into a znum first.
+    */
+    class znum_view
+    {
+    public:
+        constexpr znum_view()
+            : _signum(0),
+              _n_digits(0),
+              _digits(nullptr)
+        {}
+
+        constexpr znum_view(signum_t __signum, const digit_t *__digits, uint32_t __n_digits)
+            : _signum(__n_digits == 0 ? 0 : __signum),
+              _n_digits(__n_digits),
+              _digits(__digits)
+        {}
+
+        // implicit, so that everything that takes a view takes a znum as well
+        znum_view(const znum &a);
+
+        signum_t signum() const { return _signum; }
+        uint32_t n_digits() const { return _n_digits; }
+        const digit_t *digits() const { return _digits; }
+
+        numview to_numview() const;
+
+        // an owning copy
+        znum to_znum() const { return znum::from_digits(_signum, _digits, _n_digits); }
+
+    private:
+        signum_t _signum;
+        uint32_t _n_digits;
+        const digit_t *_digits;
+    };
+
+    signum_t compare(znum_view a, znum_view b);
+    bool operator==(znum_view a, znum_view b);
+    bool operator!=(znum_view a, znum_view b);
+    bool operator<(znum_view a, znum_view b);
+    bool operator<=(znum_view a, znum_view b);
+    bool operator>(znum_view a, znum_view b);
+    bool operator>=(znum_view a, znum_view b);
+
+    // arithmetic on views makes new znums
+    znum operator-(znum_view a);
+    znum abs(znum_view a);
+    znum operator+(znum_view a, znum_view b);
+    znum operator-(znum_view a, znum_view b);
+    znum operator*(znum_view a, znum_view b);
+    znum operator/(znum_view a, znum_view b);
+    znum operator%(znum_view a, znum_view b);
+
+    std::ostream &operator<<(std::ostream &os, znum_view a);
+    std::string to_string(znum_view a, uint32_t base = 10);
+
+    // equal values hash equally, whether they are held in a znum or seen through a view
+    size_t hash_value(znum_view a);
+
+} // namespace rqm
+
+namespace std
+{
+    template<>
+    struct hash<rqm::znum_view>
+    {
+        size_t operator()(rqm::znum_view a) const { return rqm::hash_value(a); }
+    };
+
+    template<>
+    struct hash<rqm::znum>
+    {
+        size_t operator()(const rqm::znum &a) const { return rqm::hash_value(a); }
+    };
+} // namespace std
+
+#endif // RQM_ZNUM_VIEW_H
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <stdexcept>
 
 namespace rqm
 {
@@ -17,6 +18,11 @@ namespace rqm
         return __builtin_ctz(x);
     }
 
+    static constexpr digit_t popcount(digit_t x)
+    {
+        return __builtin_popcount(x);
+    }
+
     // compare a and b, assuming both are positive. this function ignores the signs in the view
     [[nodiscard]] static signum_t abs_compare(const numview a, const numview b)
     {
@@ -54,6 +60,7 @@ namespace rqm
     }
 
     // add a and b, assuming both are positive. this function ignores the signs in the view
+    // okay to alias c with a and/or b, as long as c is large enough
     [[nodiscard]] static numview abs_add(numview c, const numview a, const numview b)
     {
         c.n_digits = 0;
@@ -93,6 +100,7 @@ namespace rqm
     }
 
     // add a and b, assuming both are positive. this function ignores the signs in the view
+    // okay to alias a and c
     [[nodiscard]] static numview abs_add_digit(numview c, const numview a, digit_t b)
     {
         c.n_digits = 0;
@@ -176,9 +184,244 @@ namespace rqm
         }
     }
 
+    /*
+      helpers for the divide-and-conquer algorithms below. these work on runs of n digits, which may have leading zeros
+     */
+
+    // c = a + b over n digits, returning the carry out. okay to alias c with a and/or b
+    static digit_t add_n(digit_t *c, const digit_t *a, const digit_t *b, uint32_t n)
+    {
+        double_digit_t carry = 0;
+        for(uint32_t idx = 0; idx < n; ++idx)
+        {
+            double_digit_t v = double_digit_t(a[idx]) + double_digit_t(b[idx]) + carry;
+            c[idx] = v;
+            carry = v >> n_bits_in_digit;
+        }
+        return carry;
+    }
+
+    // c = a - b over n digits, returning the borrow out. okay to alias c with a and/or b
+    static digit_t subtract_n(digit_t *c, const digit_t *a, const digit_t *b, uint32_t n)
+    {
+        digit_t borrow = 0;
+        for(uint32_t idx = 0; idx < n; ++idx)
+        {
+            double_digit_t v = double_digit_t(a[idx]) - double_digit_t(b[idx]) - borrow;
+            c[idx] = v;
+            borrow = (v >> n_bits_in_digit) != 0;
+        }
+        return borrow;
+    }
+
+    // adds carry into the n digits of c, returning the carry out
+    static digit_t add_carry_n(digit_t *c, uint32_t n, digit_t carry)
+    {
+        for(uint32_t idx = 0; idx < n && carry != 0; ++idx)
+        {
+            c[idx] += carry;
+            carry = c[idx] < carry;
+        }
+        return carry;
+    }
+
+    // subtracts borrow from the n digits of c, returning the borrow out
+    static digit_t subtract_borrow_n(digit_t *c, uint32_t n, digit_t borrow)
+    {
+        for(uint32_t idx = 0; idx < n && borrow != 0; ++idx)
+        {
+            digit_t v = c[idx];
+            c[idx] = v - borrow;
+            borrow = v < borrow;
+        }
+        return borrow;
+    }
+
+    // c = a*b, writing all a_n + b_n digits of c. c must not overlap a or b
+    static void schoolbook_multiply(digit_t *c, const digit_t *a, uint32_t a_n, const digit_t *b, uint32_t b_n)
+    {
+        memset(c, 0, a_n * sizeof(digit_t));
+        for(uint32_t b_idx = 0; b_idx < b_n; ++b_idx)
+        {
+            double_digit_t b_val = b[b_idx];
+            double_digit_t carry = 0;
+            for(uint32_t a_idx = 0; a_idx < a_n; ++a_idx)
+            {
+                double_digit_t v = double_digit_t(a[a_idx]) * b_val + carry + double_digit_t(c[a_idx + b_idx]);
+                c[a_idx + b_idx] = v;
+                carry = v >> n_bits_in_digit;
+            }
+            c[a_n + b_idx] = carry;
+        }
+    }
+
+    // below this many digits in the shorter operand, schoolbook multiplication is faster than splitting further
+    static constexpr uint32_t karatsuba_threshold = 40;
+
+    // c = a*b for a_n >= b_n, writing all a_n + b_n digits of c. c must not overlap a or b
+    static void karatsuba_multiply(digit_t *c, const digit_t *a, uint32_t a_n, const digit_t *b, uint32_t b_n)
+    {
+        assert(a_n >= b_n);
+        if(b_n < karatsuba_threshold)
+        {
+            schoolbook_multiply(c, a, a_n, b, b_n);
+            return;
+        }
+
+        uint32_t half = (a_n + 1) / 2;
+        if(b_n <= half)
+        {
+            // too lopsided to split both operands. multiply b by slices of a that are as long as b is, and add the partial products up
+            memset(c, 0, (a_n + b_n) * sizeof(digit_t));
+            scratch_space<digit_t> partial(2 * b_n);
+            for(uint32_t lo = 0; lo < a_n; lo += b_n)
+            {
+                uint32_t slice_n = std::min(b_n, a_n - lo);
+                if(slice_n == b_n)
+                {
+                    karatsuba_multiply(partial.data(), a + lo, slice_n, b, b_n);
+                } else
+                {
+                    karatsuba_multiply(partial.data(), b, b_n, a + lo, slice_n);
+                }
+                digit_t carry = add_n(c + lo, c + lo, partial.data(), slice_n + b_n);
+                carry = add_carry_n(c + lo + slice_n + b_n, a_n - lo - slice_n, carry);
+                assert(carry == 0);
+            }
+            return;
+        }
+
+        // a = a1*B^half + a0 and b = b1*B^half + b0. then a*b = z2*B^(2*half) + (z1 - z2 - z0)*B^half + z0 with z2 = a1*b1, z0 = a0*b0 and z1 = (a0 + a1)*(b0 + b1)
+        const digit_t *a0 = a, *a1 = a + half, *b0 = b, *b1 = b + half;
+        uint32_t a1_n = a_n - half, b1_n = b_n - half;
+        karatsuba_multiply(c, a0, half, b0, half);
+        karatsuba_multiply(c + 2 * half, a1, a1_n, b1, b1_n);
+
+        scratch_space<digit_t> tmp(4 * half + 4);
+        digit_t *a_sum = tmp.data();
+        digit_t *b_sum = a_sum + half + 1;
+        digit_t *z1 = b_sum + half + 1;
+        memcpy(a_sum, a0, half * sizeof(digit_t));
+        a_sum[half] = add_carry_n(a_sum + a1_n, half - a1_n, add_n(a_sum, a_sum, a1, a1_n));
+        memcpy(b_sum, b0, half * sizeof(digit_t));
+        b_sum[half] = add_carry_n(b_sum + b1_n, half - b1_n, add_n(b_sum, b_sum, b1, b1_n));
+        karatsuba_multiply(z1, a_sum, half + 1, b_sum, half + 1);
+
+        uint32_t z1_n = 2 * half + 2;
+        uint32_t z2_n = a1_n + b1_n;
+        subtract_borrow_n(z1 + 2 * half, 2, subtract_n(z1, z1, c, 2 * half));
+        subtract_borrow_n(z1 + z2_n, z1_n - z2_n, subtract_n(z1, z1, c + 2 * half, z2_n));
+
+        // the middle term is less than B^(a_n + b_n - half), so any digits of z1 beyond that are zero
+        uint32_t middle_n = std::min(z1_n, a_n + b_n - half);
+        digit_t carry = add_n(c + half, c + half, z1, middle_n);
+        carry = add_carry_n(c + half + middle_n, a_n + b_n - half - middle_n, carry);
+        assert(carry == 0);
+    }
+
+    // c = a^2, writing all 2*a_n digits of c. the cross products a[i]*a[j] come in equal pairs, so each is computed once and doubled, and the squares of the digits are added after
+    static void schoolbook_square(digit_t *c, const digit_t *a, uint32_t a_n)
+    {
+        memset(c, 0, 2 * a_n * sizeof(digit_t));
+        for(uint32_t i = 0; i < a_n; ++i)
+        {
+            double_digit_t a_val = a[i];
+            double_digit_t carry = 0;
+            for(uint32_t j = i + 1; j < a_n; ++j)
+            {
+                double_digit_t v = double_digit_t(a[j]) * a_val + carry + double_digit_t(c[i + j]);
+                c[i + j] = v;
+                carry = v >> n_bits_in_digit;
+            }
+            c[i + a_n] = carry;
+        }
+
+        // the cross products are less than a^2/2, so doubling them can't carry out of the top digit
+        digit_t top_bit = 0;
+        for(uint32_t idx = 0; idx < 2 * a_n; ++idx)
+        {
+            digit_t d = c[idx];
+            c[idx] = (d << 1) | top_bit;
+            top_bit = d >> (n_bits_in_digit - 1);
+        }
+
+        double_digit_t carry = 0;
+        for(uint32_t i = 0; i < a_n; ++i)
+        {
+            double_digit_t sq = double_digit_t(a[i]) * a[i];
+            double_digit_t lo = double_digit_t(c[2 * i]) + digit_t(sq) + carry;
+            c[2 * i] = lo;
+            double_digit_t hi = double_digit_t(c[2 * i + 1]) + (sq >> n_bits_in_digit) + (lo >> n_bits_in_digit);
+            c[2 * i + 1] = hi;
+            carry = hi >> n_bits_in_digit;
+        }
+        assert(carry == 0);
+    }
+
+    // squaring saves about half the digit products of the schoolbook method, so it pays to stay with it a little longer than for multiplication
+    static constexpr uint32_t karatsuba_square_threshold = 60;
+
+    // c = a^2 the karatsuba way, with three half-sized squarings. c must not overlap a
+    static void karatsuba_square(digit_t *c, const digit_t *a, uint32_t a_n)
+    {
+        if(a_n < karatsuba_square_threshold)
+        {
+            schoolbook_square(c, a, a_n);
+            return;
+        }
+
+        // a = a1*B^half + a0. then a^2 = z2*B^(2*half) + (z1 - z2 - z0)*B^half + z0 with z2 = a1^2, z0 = a0^2 and z1 = (a0 + a1)^2
+        uint32_t half = (a_n + 1) / 2;
+        const digit_t *a0 = a, *a1 = a + half;
+        uint32_t a1_n = a_n - half;
+        karatsuba_square(c, a0, half);
+        karatsuba_square(c + 2 * half, a1, a1_n);
+
+        scratch_space<digit_t> tmp(3 * half + 3);
+        digit_t *a_sum = tmp.data();
+        digit_t *z1 = a_sum + half + 1;
+        memcpy(a_sum, a0, half * sizeof(digit_t));
+        a_sum[half] = add_carry_n(a_sum + a1_n, half - a1_n, add_n(a_sum, a_sum, a1, a1_n));
+        karatsuba_square(z1, a_sum, half + 1);
+
+        uint32_t z1_n = 2 * half + 2;
+        uint32_t z2_n = 2 * a1_n;
+        subtract_borrow_n(z1 + 2 * half, 2, subtract_n(z1, z1, c, 2 * half));
+        subtract_borrow_n(z1 + z2_n, z1_n - z2_n, subtract_n(z1, z1, c + 2 * half, z2_n));
+
+        uint32_t middle_n = std::min(z1_n, 2 * a_n - half);
+        digit_t carry = add_n(c + half, c + half, z1, middle_n);
+        carry = add_carry_n(c + half + middle_n, 2 * a_n - half - middle_n, carry);
+        assert(carry == 0);
+    }
+
+    // from this many digits, multiply spots a*a and squares instead
+    static constexpr uint32_t square_threshold = 16;
+
+    [[nodiscard]] numview square(numview c, const numview a)
+    {
+        if(a.signum == 0) return zero_out(c);
+        karatsuba_square(c.digits, a.digits, a.n_digits);
+        c.n_digits = multiply_digit_estimate(a.n_digits, a.n_digits);
+        return with_signum(1, remove_high_zeros(c));
+    }
+
     // multiply of positive numbers, ignoring sign. prefer a large and b small
     [[nodiscard]] static numview abs_multiply(numview c, const numview a, const numview b)
     {
+        if(std::min(a.n_digits, b.n_digits) >= karatsuba_threshold)
+        {
+            if(a.n_digits >= b.n_digits)
+            {
+                karatsuba_multiply(c.digits, a.digits, a.n_digits, b.digits, b.n_digits);
+            } else
+            {
+                karatsuba_multiply(c.digits, b.digits, b.n_digits, a.digits, a.n_digits);
+            }
+            c.n_digits = multiply_digit_estimate(a.n_digits, b.n_digits);
+            return remove_high_zeros(c);
+        }
+
         c = zero_with_n_digits(c, multiply_digit_estimate(a.n_digits, b.n_digits));
 
         for(uint32_t b_idx = 0; b_idx < b.n_digits; ++b_idx)
@@ -207,6 +450,8 @@ namespace rqm
     {
         if(a.signum == 0) return zero_out(c);
         if(b.signum == 0) return zero_out(c);
+        // a*a. for tiny numbers the extra passes of squaring cost more than the products they save
+        if(a.digits == b.digits && a.n_digits == b.n_digits && a.n_digits >= square_threshold) return with_signum(a.signum * b.signum, square(c, a));
 
         return with_signum(a.signum * b.signum, abs_multiply(c, a, b));
     }
@@ -232,10 +477,105 @@ namespace rqm
         return c;
     }
 
-    [[nodiscard]] numview abs_divmod_by_single_digit(numview quotient, digit_t *remainder_ptr, const numview dividend, const digit_t divisor32)
+    [[nodiscard]] numview abs_multiply_add_single_digit(numview c, const numview a, digit_t b, digit_t addend)
+    {
+        double_digit_t b_val = b;
+        double_digit_t carry = addend;
+        c.n_digits = 0;
+        for(uint32_t a_idx = 0; a_idx < a.n_digits; ++a_idx)
+        {
+            double_digit_t v = double_digit_t(a.digits[a_idx]) * b_val + carry;
+            c.digits[c.n_digits++] = v;
+            carry = v >> n_bits_in_digit;
+        }
+        if(carry != 0)
+        {
+            c.digits[c.n_digits++] = carry;
+        }
+        return with_sign_unless_zero(1, remove_high_zeros(c));
+    }
+
+    [[nodiscard]] numview addmul(numview c, const numview a, const numview b)
     {
+        assert(c.digits != a.digits && c.digits != b.digits);
+        signum_t product_signum = a.signum * b.signum;
+        if(product_signum == 0) return c;
+
+        // work on a fixed width that can hold both |c| and |a*b| with a digit to spare, zero-extending c up to it
+        uint32_t width = addmul_digit_estimate(c.n_digits, a.n_digits, b.n_digits);
+        memset(c.digits + c.n_digits, 0, (width - c.n_digits) * sizeof(c.digits[0]));
+
+        if(c.signum == 0 || c.signum == product_signum)
+        {
+            // same signs, so the magnitudes add. this is the inner loop of abs_multiply, just not starting from zero
+            for(uint32_t b_idx = 0; b_idx < b.n_digits; ++b_idx)
+            {
+                double_digit_t b_val = b.digits[b_idx];
+                double_digit_t carry = 0;
+                uint32_t c_idx = b_idx;
+                for(uint32_t a_idx = 0; a_idx < a.n_digits; ++a_idx)
+                {
+                    double_digit_t v = double_digit_t(a.digits[a_idx]) * b_val + carry + double_digit_t(c.digits[c_idx]);
+                    c.digits[c_idx++] = v;
+                    carry = v >> n_bits_in_digit;
+                }
+                while(carry != 0)
+                {
+                    double_digit_t v = carry + double_digit_t(c.digits[c_idx]);
+                    c.digits[c_idx++] = v;
+                    carry = v >> n_bits_in_digit;
+                }
+            }
+            c.n_digits = width;
+            return with_sign_unless_zero(product_signum, remove_high_zeros(c));
+        }
+
+        // opposite signs. subtract the product row by row, modulo 2^(width*n_bits_in_digit). |c| - |a*b| is strictly between -2^width and 2^width,
+        // so the running difference wraps around at most once, and it wraps exactly when the product is the larger of the two
+        bool wrapped = false;
+        for(uint32_t b_idx = 0; b_idx < b.n_digits; ++b_idx)
+        {
+            double_digit_t b_val = b.digits[b_idx];
+            double_digit_t borrow = 0;
+            uint32_t c_idx = b_idx;
+            for(uint32_t a_idx = 0; a_idx < a.n_digits; ++a_idx)
+            {
+                double_digit_t v = double_digit_t(a.digits[a_idx]) * b_val + borrow;
+                digit_t low = v;
+                digit_t cd = c.digits[c_idx];
+                c.digits[c_idx++] = cd - low;
+                borrow = (v >> n_bits_in_digit) + (cd < low);
+            }
+            while(borrow != 0 && c_idx < width)
+            {
+                digit_t cd = c.digits[c_idx];
+                c.digits[c_idx++] = cd - digit_t(borrow);
+                borrow = cd < borrow;
+            }
+            wrapped |= borrow != 0;
+        }
+
+        c.n_digits = width;
+        if(!wrapped)
+        {
+            return with_sign_unless_zero(c.signum, remove_high_zeros(c));
+        }
 
-        quotient = zero_with_n_digits(quotient, dividend.n_digits);
+        // the product won. we hold 2^width - (|a*b| - |c|), so take the two's complement to get the magnitude back
+        double_digit_t carry = 1;
+        for(uint32_t idx = 0; idx < width; ++idx)
+        {
+            double_digit_t v = double_digit_t(digit_t(~c.digits[idx])) + carry;
+            c.digits[idx] = v;
+            carry = v >> n_bits_in_digit;
+        }
+        return with_sign_unless_zero(product_signum, remove_high_zeros(c));
+    }
+
+    // okay to alias quotient and dividend. each quotient digit is written after the corresponding dividend digit has been read
+    [[nodiscard]] numview abs_divmod_by_single_digit(numview quotient, digit_t *remainder_ptr, const numview dividend, const digit_t divisor32)
+    {
+        quotient.n_digits = dividend.n_digits;
 
         double_digit_t remainder = 0;
         double_digit_t divisor = divisor32;
@@ -286,7 +626,7 @@ namespace rqm
         uint32_t n = divisor.n_digits;
         uint32_t m = dividend.n_digits - n - 1;
 
-        MAKE_STACK_TEMPORARY_NUMVIEW(qv, n + 1);
+        MAKE_TEMPORARY_NUMVIEW(qv, n + 1);
 
         constexpr double_digit_t b = double_digit_t(1) << n_bits_in_digit;
         for(int32_t j = m; j >= 0; j--)
@@ -308,6 +648,7 @@ namespace rqm
             numview dividend_until_j = dividend;
             dividend_until_j.digits += j;
             dividend_until_j.n_digits = n + 1;
+            dividend_until_j = remove_high_zeros(dividend_until_j); // abs_compare goes by the number of digits first
 
             qv = multiply_with_single_digit(qv, divisor, q_hat);
             while(abs_compare(dividend_until_j, qv) < 0)
@@ -325,6 +666,160 @@ namespace rqm
         return with_sign_unless_zero(dividend.signum * divisor.signum, remove_high_zeros(quotient));
     }
 
+    /*
+      Burnikel and Ziegler's recursive division, "Fast Recursive Division", MPI-I-98-1-022.
+      Dividing 2n digits by n becomes two divisions of 3n/2 by n digits, each of which is a division of n by n/2 digits plus an n/2 by n/2 digit multiplication.
+      With Karatsuba multiplication underneath, this is subquadratic. all the numbers in here are non-negative
+     */
+
+    // below this many divisor digits, Knuth's algorithm D is faster than recursing further
+    static constexpr uint32_t burnikel_ziegler_threshold = 80;
+
+    // the digits of a from index lo upwards, sharing storage with a
+    [[nodiscard]] static numview digits_from(const numview a, uint32_t lo)
+    {
+        if(a.n_digits <= lo) return numview(0, 0, a.digits);
+        return numview(a.n_digits - lo, 1, a.digits + lo);
+    }
+
+    // the digits of a below index hi, sharing storage with a
+    [[nodiscard]] static numview digits_below(const numview a, uint32_t hi)
+    {
+        return with_sign_unless_zero(1, remove_high_zeros(numview(std::min(a.n_digits, hi), 1, a.digits)));
+    }
+
+    // c = hi*B^shift + lo, for lo < B^shift. c must not overlap hi or lo
+    [[nodiscard]] static numview join_digits(numview c, const numview hi, const numview lo, uint32_t shift)
+    {
+        if(hi.n_digits == 0) return with_sign_unless_zero(1, copy_view(c, lo));
+        memcpy(c.digits, lo.digits, lo.n_digits * sizeof(digit_t));
+        memset(c.digits + lo.n_digits, 0, (shift - lo.n_digits) * sizeof(digit_t));
+        memcpy(c.digits + shift, hi.digits, hi.n_digits * sizeof(digit_t));
+        c.n_digits = shift + hi.n_digits;
+        c.signum = 1;
+        return c;
+    }
+
+    // the base case, a < b*B^n for a normalised divisor b of n digits. the quotient needs room for n + 1 digits, the remainder for n
+    [[nodiscard]] static numview divide_2n_by_n_base(numview quotient, numview *remainder, const numview a, const numview b)
+    {
+        if(abs_compare(a, b) < 0)
+        {
+            *remainder = copy_view(*remainder, a);
+            return zero_out(quotient);
+        }
+        MAKE_TEMPORARY_NUMVIEW(padded, a.n_digits + 1);
+        padded = copy_view(padded, a);
+        padded.digits[padded.n_digits++] = 0; // divmod_normalised needs an extra zero on top
+        numview padded_remainder = padded;
+        quotient = divmod_normalised(quotient, &padded_remainder, padded, b);
+        *remainder = with_sign_unless_zero(1, copy_view(*remainder, padded_remainder));
+        return quotient;
+    }
+
+    [[nodiscard]] static numview divide_3n_by_2n(numview quotient, numview *remainder, const numview a12, const numview a3, const numview b, uint32_t half);
+
+    // a < b*B^n for a normalised divisor b of n digits. the quotient needs room for n + 1 digits, the remainder for n + 2
+    [[nodiscard]] static numview divide_2n_by_n(numview quotient, numview *remainder, const numview a, const numview b)
+    {
+        uint32_t n = b.n_digits;
+        if(n % 2 != 0 || n < burnikel_ziegler_threshold) return divide_2n_by_n_base(quotient, remainder, a, b);
+
+        // the top three quarters of a give the high half of the quotient. that remainder and the last quarter of a then give the low half
+        uint32_t half = n / 2;
+        MAKE_TEMPORARY_NUMVIEW(q_high, half + 1);
+        MAKE_TEMPORARY_NUMVIEW(r_high, n + 2);
+        q_high = divide_3n_by_2n(q_high, &r_high, digits_from(a, n), digits_below(digits_from(a, half), half), b, half);
+        numview q_low = divide_3n_by_2n(quotient, remainder, r_high, digits_below(a, half), b, half);
+
+        // q_low is already in place at the bottom of quotient
+        if(q_high.n_digits == 0) return q_low;
+        memset(quotient.digits + q_low.n_digits, 0, (half - q_low.n_digits) * sizeof(digit_t));
+        memcpy(quotient.digits + half, q_high.digits, q_high.n_digits * sizeof(digit_t));
+        quotient.n_digits = half + q_high.n_digits;
+        quotient.signum = 1;
+        return quotient;
+    }
+
+    // a12*B^half + a3 < b*B^half for a normalised divisor b of 2*half digits, and a3 < B^half. the quotient needs room for half + 1 digits, the remainder for 2*half + 2
+    [[nodiscard]] static numview divide_3n_by_2n(numview quotient, numview *remainder, const numview a12, const numview a3, const numview b, uint32_t half)
+    {
+        uint32_t n = b.n_digits;
+        numview b1 = digits_from(b, half);
+        numview b2 = digits_below(b, half);
+
+        // estimate the quotient from the top digits of the divisor alone. the estimate is never too small, and at most two too large
+        if(abs_compare(digits_from(a12, half), b1) == 0)
+        {
+            // the estimate would not fit in half digits, so clamp it to B^half - 1. the remainder is then a12 - (B^half - 1)*b1 = (a12 - b1*B^half) + b1
+            for(uint32_t idx = 0; idx < half; ++idx)
+            {
+                quotient.digits[idx] = ~digit_t(0);
+            }
+            quotient.n_digits = half;
+            quotient.signum = 1;
+            *remainder = add(*remainder, digits_below(a12, half), b1);
+        } else
+        {
+            quotient = divide_2n_by_n(quotient, remainder, a12, b1);
+        }
+
+        // bring in the rest of the dividend and the part of the product that involves the low digits of the divisor, correcting the estimate down
+        MAKE_TEMPORARY_NUMVIEW(joined, n + 2);
+        MAKE_TEMPORARY_NUMVIEW(product, n);
+        joined = join_digits(joined, *remainder, a3, half);
+        product = multiply(product, quotient, b2);
+        *remainder = add(*remainder, joined, negate(product));
+        static const digit_t one_digit = 1;
+        while(remainder->signum < 0)
+        {
+            quotient = add(quotient, quotient, numview(1, -1, &one_digit));
+            *remainder = add(*remainder, *remainder, b);
+        }
+        return quotient;
+    }
+
+    // dividend and divisor are normalised and positive. the remainder may share storage with the dividend
+    [[nodiscard]] static numview divmod_recursive(numview quotient, numview *remainder, const numview dividend, const numview divisor)
+    {
+        // pad the divisor with low zero digits up to m*2^k digits for an m below the threshold, so that it halves evenly all the way down to the base case.
+        // the dividend gets the same padding, which leaves the quotient unchanged and pads the remainder
+        uint32_t m = divisor.n_digits;
+        uint32_t k = 0;
+        while(m >= burnikel_ziegler_threshold)
+        {
+            m = (m + 1) / 2;
+            ++k;
+        }
+        uint32_t n = m << k;
+        uint32_t pad = n - divisor.n_digits;
+        numview nothing(0, 0, divisor.digits);
+        MAKE_TEMPORARY_NUMVIEW(b, n);
+        MAKE_TEMPORARY_NUMVIEW(a, dividend.n_digits + pad);
+        b = join_digits(b, divisor, nothing, pad);
+        a = join_digits(a, dividend, nothing, pad);
+
+        // go through the dividend n digits at a time from the top, carrying the remainder down
+        uint32_t n_blocks = cdiv(a.n_digits, n);
+        MAKE_TEMPORARY_NUMVIEW(q, n_blocks * n);
+        MAKE_TEMPORARY_NUMVIEW(r, n + 2);
+        MAKE_TEMPORARY_NUMVIEW(x, 2 * n);
+        MAKE_TEMPORARY_NUMVIEW(q_block, n + 1);
+        r = zero_out(r);
+        for(int64_t block = n_blocks - 1; block >= 0; --block)
+        {
+            x = join_digits(x, r, digits_below(digits_from(a, block * n), n), n);
+            q_block = divide_2n_by_n(q_block, &r, x, b);
+            memcpy(q.digits + block * n, q_block.digits, q_block.n_digits * sizeof(digit_t));
+            memset(q.digits + block * n + q_block.n_digits, 0, (n - q_block.n_digits) * sizeof(digit_t));
+        }
+        q.n_digits = n_blocks * n;
+        q = with_sign_unless_zero(1, remove_high_zeros(q));
+
+        *remainder = with_sign_unless_zero(1, copy_view(*remainder, digits_from(r, pad)));
+        return copy_view(quotient, q);
+    }
+
     [[nodiscard]] numview divmod(numview quotient, numview *remainder, const numview dividend, const numview divisor)
     {
         if(divisor.signum == 0) throw std::out_of_range("divide by zero");
@@ -334,9 +829,8 @@ namespace rqm
             return zero_out(quotient);
         }
         uint32_t normalization_shift = countl_zero(divisor.digits[divisor.n_digits - 1]);
-        MAKE_STACK_TEMPORARY_NUMVIEW(norm_dividend, dividend.n_digits + 1);
-        MAKE_STACK_TEMPORARY_NUMVIEW(norm_divisor, divisor.n_digits); // won't overflow
-        MAKE_STACK_TEMPORARY_NUMVIEW(norm_remainder, divisor.n_digits);
+        MAKE_TEMPORARY_NUMVIEW(norm_dividend, dividend.n_digits + 1);
+        MAKE_TEMPORARY_NUMVIEW(norm_divisor, divisor.n_digits); // won't overflow
         norm_dividend = shift_left(norm_dividend, dividend, normalization_shift);
         norm_divisor = shift_left(norm_divisor, divisor, normalization_shift);
 
@@ -345,7 +839,16 @@ namespace rqm
             norm_dividend.digits[norm_dividend.n_digits++] = 0; // put an extra zero in there, the divmod_normalised algorithm needs it
         }
 
-        quotient = divmod_normalised(quotient, &norm_remainder, norm_dividend, norm_divisor);
+        numview norm_remainder = norm_dividend; // the remainder is left in the low digits of the normalised dividend
+        if(divisor.n_digits >= burnikel_ziegler_threshold && dividend.n_digits - divisor.n_digits >= burnikel_ziegler_threshold)
+        {
+            quotient = divmod_recursive(quotient, &norm_remainder, abs(remove_high_zeros(norm_dividend)), abs(norm_divisor));
+            quotient = with_sign_unless_zero(dividend.signum * divisor.signum, quotient);
+            norm_remainder = with_sign_unless_zero(dividend.signum, norm_remainder);
+        } else
+        {
+            quotient = divmod_normalised(quotient, &norm_remainder, norm_dividend, norm_divisor);
+        }
         if(remainder != nullptr)
         {
             if(norm_remainder.n_digits == 0) norm_remainder.signum = 0;
@@ -354,6 +857,7 @@ namespace rqm
         return quotient;
     }
 
+    // okay to alias a and c, as long as c is large enough. we work from the most significant digit downwards, so we never overwrite a digit we have yet to read
     [[nodiscard]] numview shift_left(numview c, const numview a, uint32_t shift_amount)
     {
         if(a.signum == 0) return zero_out(c);
@@ -362,36 +866,35 @@ namespace rqm
         uint32_t shift_whole_digits = shift_amount / n_bits_in_digit;
         uint32_t shift_left_within_digits = shift_amount % n_bits_in_digit;
 
-        c.n_digits = 0;
-        for(uint32_t idx = 0; idx < shift_whole_digits; ++idx)
-        {
-            c.digits[c.n_digits++] = 0;
-        }
-
+        c.n_digits = a.n_digits + shift_whole_digits;
         if(shift_left_within_digits == 0)
         {
-            for(uint32_t idx = 0; idx < a.n_digits; ++idx)
+            for(int64_t idx = a.n_digits - 1; idx >= 0; --idx)
             {
-                c.digits[c.n_digits++] = a.digits[idx];
+                c.digits[idx + shift_whole_digits] = a.digits[idx];
             }
         } else
         {
             uint32_t shift_right_within_digits = n_bits_in_digit - shift_left_within_digits;
-            digit_t extra = 0;
-            for(uint32_t idx = 0; idx < a.n_digits; ++idx)
-            {
-                digit_t ad = a.digits[idx];
-                c.digits[c.n_digits++] = extra | (ad << shift_left_within_digits);
-                extra = ad >> shift_right_within_digits;
-            }
+            digit_t extra = a.digits[a.n_digits - 1] >> shift_right_within_digits;
             if(extra != 0)
             {
                 c.digits[c.n_digits++] = extra;
             }
+            for(int64_t idx = a.n_digits - 1; idx >= 1; --idx)
+            {
+                c.digits[idx + shift_whole_digits] = (a.digits[idx] << shift_left_within_digits) | (a.digits[idx - 1] >> shift_right_within_digits);
+            }
+            c.digits[shift_whole_digits] = a.digits[0] << shift_left_within_digits;
+        }
+        for(uint32_t idx = 0; idx < shift_whole_digits; ++idx)
+        {
+            c.digits[idx] = 0;
         }
         return c;
     }
 
+    // okay to alias a and c. we work from the least significant digit upwards, so we never overwrite a digit we have yet to read
     [[nodiscard]] numview shift_right(numview c, const numview a, uint32_t shift_amount)
     {
         if(a.signum == 0) return zero_out(c);
@@ -400,47 +903,47 @@ namespace rqm
         uint32_t shift_right_within_digits = shift_amount % n_bits_in_digit;
         uint32_t shift_left_within_digits = n_bits_in_digit - shift_right_within_digits;
 
-        digit_t extra = 0;
-        c.n_digits = std::max<int64_t>(0, a.n_digits - shift_whole_digits);
+        // arithmetic shift right is a flooring division. therefore, if we have a negative a, we should add 1 to the magnitude (in sign-magnitude representation) if we shift out any 1 bits.
+        // figure that out before we start writing to c, which may be the same storage as a
+        bool round_up = false;
+        if(a.signum == -1)
+        {
+            for(uint32_t idx = 0; idx < shift_whole_digits && idx < a.n_digits; ++idx)
+            {
+                round_up = a.digits[idx] != 0;
+                if(round_up) break;
+            }
+            if(!round_up && shift_whole_digits < a.n_digits && shift_right_within_digits != 0)
+            {
+                round_up = (a.digits[shift_whole_digits] << shift_left_within_digits) != 0;
+            }
+        }
+
+        c.n_digits = std::max<int64_t>(0, int64_t(a.n_digits) - int64_t(shift_whole_digits));
         if(shift_right_within_digits == 0)
         {
-            for(int64_t idx = a.n_digits - 1 - shift_whole_digits; idx >= 0; --idx)
+            for(uint32_t idx = 0; idx < c.n_digits; ++idx)
             {
-                digit_t ad = a.digits[idx + shift_whole_digits];
-                c.digits[idx] = ad;
+                c.digits[idx] = a.digits[idx + shift_whole_digits];
             }
 
         } else
         {
-            for(int64_t idx = a.n_digits - 1 - shift_whole_digits; idx >= 0; --idx)
+            for(uint32_t idx = 0; idx < c.n_digits; ++idx)
             {
                 digit_t ad = a.digits[idx + shift_whole_digits];
-
-                c.digits[idx] = extra | (ad >> shift_right_within_digits);
-                extra = ad << shift_left_within_digits;
+                digit_t next = idx + 1 < c.n_digits ? a.digits[idx + shift_whole_digits + 1] : 0;
+                c.digits[idx] = (ad >> shift_right_within_digits) | (next << shift_left_within_digits);
             }
         }
 
-        // arithmetic shift right is a flooring division. therefore, if we have a negative a, we should add 1 to the magnitude (in sign-magnitude representation) if we shift out any 1 bits
-        if(a.signum == -1)
+        c = remove_high_zeros(c);
+        if(round_up)
         {
-            bool round_up = extra != 0;
-            if(!round_up)
-            {
-                for(uint32_t idx = 0; idx < shift_whole_digits && idx < a.n_digits; ++idx)
-                {
-                    round_up = a.digits[idx] != 0;
-                    if(round_up) break;
-                }
-            }
-            if(round_up)
-            {
-                // a little naughty, our routines are generally not resistant against aliasing. but this one is safe
-                c = abs_add_digit(c, c, 1);
-            }
+            c = abs_add_digit(c, c, 1);
         }
 
-        return with_sign_unless_zero(a.signum, remove_high_zeros(c));
+        return with_sign_unless_zero(a.signum, c);
     }
 
     uint32_t countr_zero(const numview v)
@@ -459,6 +962,134 @@ namespace rqm
         return result;
     }
 
+    /*
+      the digits of a number in two's complement, least significant first and sign-extended forever.
+      a negative -m is ~m + 1, and the +1 only carries through the low zero digits of m, so each digit takes a xor, an add and a carry update
+     */
+    class twos_complement_digits
+    {
+    public:
+        explicit twos_complement_digits(const numview _v)
+            : v(_v),
+              flip(_v.signum < 0 ? ~digit_t(0) : 0),
+              carry(_v.signum < 0 ? 1 : 0)
+        {}
+
+        // call for idx = 0, 1, 2, ... in order
+        digit_t next(uint32_t idx)
+        {
+            digit_t d = ((idx < v.n_digits ? v.digits[idx] : 0) ^ flip) + carry;
+            carry &= d == 0;
+            return d;
+        }
+
+        digit_t sign_extension() const { return flip; }
+
+    private:
+        numview v;
+        digit_t flip;
+        digit_t carry;
+    };
+
+    template<typename Op>
+    [[nodiscard]] static numview bitwise(numview c, const numview a, const numview b, Op op)
+    {
+        if(a.signum >= 0 && b.signum >= 0)
+        {
+            // no complements involved, so this is a plain loop over the digits the compiler can vectorise
+            uint32_t n_common = std::min(a.n_digits, b.n_digits);
+            for(uint32_t idx = 0; idx < n_common; ++idx)
+            {
+                c.digits[idx] = op(a.digits[idx], b.digits[idx]);
+            }
+            // past the shorter operand, the result is either zero or the rest of the longer one
+            uint32_t n = n_common;
+            if(op(digit_t(0), ~digit_t(0)) != 0)
+            {
+                const numview &longer = a.n_digits > b.n_digits ? a : b;
+                for(; n < longer.n_digits; ++n)
+                {
+                    c.digits[n] = longer.digits[n];
+                }
+            }
+            c.n_digits = n;
+            return with_sign_unless_zero(1, remove_high_zeros(c));
+        }
+
+        twos_complement_digits ad(a), bd(b);
+        // the sign of the result is the operation on the sign extensions, and a negative result goes back to sign-magnitude the same way it came in
+        digit_t c_flip = op(ad.sign_extension(), bd.sign_extension());
+        digit_t c_carry = c_flip & 1;
+        uint32_t n = bitwise_digit_estimate(a.n_digits, b.n_digits);
+        for(uint32_t idx = 0; idx < n; ++idx)
+        {
+            digit_t cd = (op(ad.next(idx), bd.next(idx)) ^ c_flip) + c_carry;
+            c_carry &= cd == 0;
+            c.digits[idx] = cd;
+        }
+        c.n_digits = n;
+        return with_sign_unless_zero(c_flip != 0 ? -1 : 1, remove_high_zeros(c));
+    }
+
+    [[nodiscard]] numview bitwise_and(numview c, const numview a, const numview b)
+    {
+        return bitwise(c, a, b, [](digit_t x, digit_t y) { return x & y; });
+    }
+
+    [[nodiscard]] numview bitwise_or(numview c, const numview a, const numview b)
+    {
+        return bitwise(c, a, b, [](digit_t x, digit_t y) { return x | y; });
+    }
+
+    [[nodiscard]] numview bitwise_xor(numview c, const numview a, const numview b)
+    {
+        return bitwise(c, a, b, [](digit_t x, digit_t y) { return x ^ y; });
+    }
+
+    [[nodiscard]] bool test_bit(const numview a, uint64_t bit)
+    {
+        uint64_t idx = bit / n_bits_in_digit;
+        uint32_t bit_in_digit = bit % n_bits_in_digit;
+        if(a.signum >= 0) return idx < a.n_digits && ((a.digits[idx] >> bit_in_digit) & 1) != 0;
+
+        // -m in two's complement: zero below the lowest non-zero digit of m, negated in it, and inverted above it
+        if(idx >= a.n_digits) return true;
+        uint32_t lowest = 0;
+        while(a.digits[lowest] == 0)
+        {
+            ++lowest;
+        }
+        if(idx < lowest) return false;
+        digit_t d = idx == lowest ? digit_t(-a.digits[idx]) : digit_t(~a.digits[idx]);
+        return ((d >> bit_in_digit) & 1) != 0;
+    }
+
+    [[nodiscard]] uint64_t popcount(const numview a)
+    {
+        if(a.signum < 0) return UINT64_MAX;
+        uint64_t result = 0;
+        for(uint32_t idx = 0; idx < a.n_digits; ++idx)
+        {
+            result += popcount(a.digits[idx]);
+        }
+        return result;
+    }
+
+    [[nodiscard]] uint64_t hamming_distance(const numview a, const numview b)
+    {
+        if((a.signum < 0) != (b.signum < 0)) return UINT64_MAX;
+
+        // with equal signs, the sign extensions agree, so only the digits up to the longer operand can differ
+        twos_complement_digits ad(a), bd(b);
+        uint64_t result = 0;
+        uint32_t n = std::max(a.n_digits, b.n_digits);
+        for(uint32_t idx = 0; idx < n; ++idx)
+        {
+            result += popcount(ad.next(idx) ^ bd.next(idx));
+        }
+        return result;
+    }
+
     [[nodiscard]] numview binary_gcd(numview c, numview a, numview b)
     {
         // make both sides non-negative
@@ -469,8 +1100,8 @@ namespace rqm
         if(a.signum == 0) return copy_view(c, b);
         if(b.signum == 0) return copy_view(c, a);
 
-        MAKE_STACK_TEMPORARY_NUMVIEW(aa, a.n_digits);
-        MAKE_STACK_TEMPORARY_NUMVIEW(bb, b.n_digits);
+        MAKE_TEMPORARY_NUMVIEW(aa, a.n_digits);
+        MAKE_TEMPORARY_NUMVIEW(bb, b.n_digits);
 
         uint32_t a_n_pow2s = countr_zero(a);
         uint32_t b_n_pow2s = countr_zero(b);
@@ -496,4 +1127,177 @@ namespace rqm
         return shift_left(c, aa, common_pow2s);
     }
 
+    // the limbs of a mod m, two digits to a limb
+    static void reduce_to_limbs(double_digit_t *c, uint32_t n_limbs, const numview a, const numview m)
+    {
+        MAKE_TEMPORARY_NUMVIEW(quotient, quotient_digit_estimate(a.n_digits, m.n_digits));
+        MAKE_TEMPORARY_NUMVIEW(remainder, modulo_digit_estimate(a.n_digits, m.n_digits));
+        quotient = divmod(quotient, &remainder, abs(a), m);
+        std::fill(c, c + n_limbs, 0);
+        for(uint32_t idx = 0; idx < remainder.n_digits; ++idx)
+        {
+            c[idx / 2] |= double_digit_t(remainder.digits[idx]) << (n_bits_in_digit * (idx % 2));
+        }
+    }
+
+    // compares the n-limb runs a and b
+    [[nodiscard]] static signum_t compare_limbs(const double_digit_t *a, const double_digit_t *b, uint32_t n)
+    {
+        for(int32_t idx = n - 1; idx >= 0; --idx)
+        {
+            if(a[idx] != b[idx]) return internal_compare_unequal(a[idx], b[idx]);
+        }
+        return 0;
+    }
+
+    // c = a + b over n limbs, returning the carry out
+    static double_digit_t add_limbs(double_digit_t *c, const double_digit_t *a, const double_digit_t *b, uint32_t n)
+    {
+        quad_digit_t carry = 0;
+        for(uint32_t idx = 0; idx < n; ++idx)
+        {
+            carry += quad_digit_t(a[idx]) + b[idx];
+            c[idx] = double_digit_t(carry);
+            carry >>= n_double_digit_bits;
+        }
+        return double_digit_t(carry);
+    }
+
+    // c = a - b over n limbs, returning the borrow out
+    static double_digit_t subtract_limbs(double_digit_t *c, const double_digit_t *a, const double_digit_t *b, uint32_t n)
+    {
+        double_digit_t borrow = 0;
+        for(uint32_t idx = 0; idx < n; ++idx)
+        {
+            quad_digit_t v = quad_digit_t(a[idx]) - b[idx] - borrow;
+            c[idx] = double_digit_t(v);
+            borrow = (v >> n_double_digit_bits) != 0;
+        }
+        return borrow;
+    }
+
+    montgomery_modulus::montgomery_modulus(const numview _m)
+        : n(cdiv<uint32_t>(_m.n_digits, 2)),
+          m(n),
+          r(n),
+          r2(n),
+          t(n + 2)
+    {
+        assert(_m.signum > 0 && (_m.digits[0] & 1));
+        numview m_view = with_signum(1, _m);
+        for(uint32_t idx = 0; idx < _m.n_digits; ++idx)
+        {
+            m[idx / 2] |= double_digit_t(_m.digits[idx]) << (n_bits_in_digit * (idx % 2));
+        }
+
+        // newton's iteration for the inverse mod 2^64 doubles the correct low bits each step, and m is its own inverse mod 8
+        double_digit_t inv = m[0];
+        for(int idx = 0; idx < 5; ++idx)
+        {
+            inv *= 2 - m[0] * inv;
+        }
+        m_inv = -inv;
+
+        // R mod m and R^2 mod m, the latter for getting into montgomery form
+        MAKE_TEMPORARY_NUMVIEW(power, 4 * n + 1);
+        power = zero_with_n_digits(power, 2 * n + 1);
+        power.digits[2 * n] = 1;
+        power.signum = 1;
+        reduce_to_limbs(r.data(), n, power, m_view);
+        power = zero_with_n_digits(power, 4 * n + 1);
+        power.digits[4 * n] = 1;
+        power.signum = 1;
+        reduce_to_limbs(r2.data(), n, power, m_view);
+    }
+
+    void montgomery_modulus::to_montgomery(double_digit_t *c, const numview a) const
+    {
+        MAKE_TEMPORARY_NUMVIEW(m_view, 2 * n);
+        for(uint32_t idx = 0; idx < 2 * n; ++idx)
+        {
+            m_view.digits[idx] = digit_t(m[idx / 2] >> (n_bits_in_digit * (idx % 2)));
+        }
+        m_view.n_digits = 2 * n;
+        m_view.signum = 1;
+        m_view = remove_high_zeros(m_view);
+        reduce_to_limbs(c, n, a, m_view);
+        multiply(c, c, r2.data());
+    }
+
+    void montgomery_modulus::multiply(double_digit_t *c, const double_digit_t *a, const double_digit_t *b) const
+    {
+        // interleaved multiplication and reduction, a limb of b at a time. each step adds the multiple of m that clears the low limb, and shifts it out
+        double_digit_t *acc = t.data();
+        std::fill(acc, acc + n + 2, 0);
+        for(uint32_t i = 0; i < n; ++i)
+        {
+            quad_digit_t carry = 0;
+            double_digit_t bi = b[i];
+            for(uint32_t j = 0; j < n; ++j)
+            {
+                carry += quad_digit_t(a[j]) * bi + acc[j];
+                acc[j] = double_digit_t(carry);
+                carry >>= n_double_digit_bits;
+            }
+            carry += acc[n];
+            acc[n] = double_digit_t(carry);
+            acc[n + 1] = double_digit_t(carry >> n_double_digit_bits);
+
+            double_digit_t u = acc[0] * m_inv;
+            carry = (quad_digit_t(u) * m[0] + acc[0]) >> n_double_digit_bits;
+            for(uint32_t j = 1; j < n; ++j)
+            {
+                carry += quad_digit_t(u) * m[j] + acc[j];
+                acc[j - 1] = double_digit_t(carry);
+                carry >>= n_double_digit_bits;
+            }
+            carry += acc[n];
+            acc[n - 1] = double_digit_t(carry);
+            acc[n] = acc[n + 1] + double_digit_t(carry >> n_double_digit_bits);
+        }
+
+        // the result is below 2m
+        if(acc[n] != 0 || compare_limbs(acc, m.data(), n) >= 0)
+        {
+            subtract_limbs(c, acc, m.data(), n);
+        } else
+        {
+            std::copy(acc, acc + n, c);
+        }
+    }
+
+    void montgomery_modulus::add(double_digit_t *c, const double_digit_t *a, const double_digit_t *b) const
+    {
+        double_digit_t carry = add_limbs(c, a, b, n);
+        if(carry != 0 || compare_limbs(c, m.data(), n) >= 0) subtract_limbs(c, c, m.data(), n);
+    }
+
+    void montgomery_modulus::subtract(double_digit_t *c, const double_digit_t *a, const double_digit_t *b) const
+    {
+        if(subtract_limbs(c, a, b, n) != 0) add_limbs(c, c, m.data(), n);
+    }
+
+    void montgomery_modulus::halve(double_digit_t *c, const double_digit_t *a) const
+    {
+        // an odd a becomes the even a + m first, which has the same value
+        double_digit_t carry = 0;
+        if(a[0] & 1)
+        {
+            carry = add_limbs(c, a, m.data(), n);
+        } else
+        {
+            std::copy(a, a + n, c);
+        }
+        for(uint32_t idx = 0; idx + 1 < n; ++idx)
+        {
+            c[idx] = (c[idx] >> 1) | (c[idx + 1] << (n_double_digit_bits - 1));
+        }
+        c[n - 1] = (c[n - 1] >> 1) | (carry << (n_double_digit_bits - 1));
+    }
+
+    bool montgomery_modulus::is_zero(const double_digit_t *a) const
+    {
+        return std::all_of(a, a + n, [](double_digit_t limb) { return limb == 0; });
+    }
+
 } // namespace rqm
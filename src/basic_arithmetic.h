@@ -7,6 +7,7 @@
 #include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <vector>
 
 namespace rqm
 {
@@ -14,7 +15,7 @@ namespace rqm
     {
         dest.signum = src.signum;
         dest.n_digits = src.n_digits;
-        memcpy(dest.digits, src.digits, src.n_digits * sizeof(src.digits[0]));
+        memmove(dest.digits, src.digits, src.n_digits * sizeof(src.digits[0])); // memmove, as the in-place operations may hand us overlapping views
         return dest;
     }
 
@@ -105,6 +106,20 @@ namespace rqm
 
     [[nodiscard]] numview multiply_with_single_digit(numview c, const numview a, digit_t b);
 
+    // c = a^2, in about half the digit products of a general multiplication. c must have room for multiply_digit_estimate(a, a) digits, and must not alias a
+    [[nodiscard]] numview square(numview c, const numview a);
+
+    // c = |a|*b + addend in one pass, for building up a number a digit at a time. okay to alias a and c, and c needs room for one more digit than a
+    [[nodiscard]] numview abs_multiply_add_single_digit(numview c, const numview a, digit_t b, digit_t addend);
+
+    [[nodiscard]] constexpr static inline uint32_t addmul_digit_estimate(uint32_t c_digits, uint32_t a_digits, uint32_t b_digits)
+    {
+        return std::max(c_digits, multiply_digit_estimate(a_digits, b_digits)) + 1;
+    }
+
+    // computes c + a*b, accumulating the product directly into the digits of c. c must have room for addmul_digit_estimate digits, and must not alias a or b
+    [[nodiscard]] numview addmul(numview c, const numview a, const numview b);
+
     [[nodiscard]] constexpr static inline uint32_t quotient_digit_estimate(uint32_t dividend_digits, uint32_t divisor_digits)
     {
         return std::max<int64_t>(0, int64_t(dividend_digits) - int64_t(divisor_digits) + 1);
@@ -135,7 +150,7 @@ namespace rqm
     [[nodiscard]] constexpr static inline uint32_t shift_right_digit_estimate(uint32_t a_digits, uint32_t right_shift_amount)
     {
         // make sure we always have one digit present, just in case.
-        return std::max<int64_t>(1, a_digits - right_shift_amount / n_bits_in_digit);
+        return std::max<int64_t>(1, int64_t(a_digits) - int64_t(right_shift_amount / n_bits_in_digit));
     }
 
     [[nodiscard]] numview shift_left(numview c, const numview a, uint32_t shift_amount);
@@ -144,13 +159,75 @@ namespace rqm
 
     uint32_t countr_zero(const numview v);
 
+    /*
+      bitwise operations treat the numbers as two's complement with infinite sign extension, consistently with the flooring shift_right.
+      the complements of negative operands are produced a digit at a time while combining, never stored, and c may be the same storage as a or b
+     */
+    [[nodiscard]] constexpr static inline uint32_t bitwise_digit_estimate(uint32_t a_digits, uint32_t b_digits)
+    {
+        // a negative result can carry into one more digit when converted back to sign-magnitude
+        return std::max(a_digits, b_digits) + 1;
+    }
+
+    [[nodiscard]] numview bitwise_and(numview c, const numview a, const numview b);
+    [[nodiscard]] numview bitwise_or(numview c, const numview a, const numview b);
+    [[nodiscard]] numview bitwise_xor(numview c, const numview a, const numview b);
+
+    [[nodiscard]] bool test_bit(const numview a, uint64_t bit);
+
+    // the number of set bits. negative numbers have infinitely many, and give UINT64_MAX
+    [[nodiscard]] uint64_t popcount(const numview a);
+
+    // the number of bits that differ. infinite, and UINT64_MAX, when exactly one of a and b is negative
+    [[nodiscard]] uint64_t hamming_distance(const numview a, const numview b);
+
     [[nodiscard]] constexpr static inline uint32_t gcd_digit_estimate(uint32_t a_digits, uint32_t b_digits)
     {
+        // gcd(a, 0) = a, so a zero operand means we need room for the whole of the other one
+        if(a_digits == 0) return b_digits;
+        if(b_digits == 0) return a_digits;
         return std::min(a_digits, b_digits);
     }
 
     [[nodiscard]] numview binary_gcd(numview c, numview a, numview b);
 
+    /*
+      arithmetic modulo an odd positive m, in montgomery form, where x is kept as x*R mod m with R = 2^(64n) for the n double digits ("limbs") of m.
+      multiplication then needs no division, only a multiply-and-add of the modulus per limb, and working in limbs halves the number of digit products.
+      operands and results are runs of exactly n_limbs() limbs reduced below m, and results may alias operands.
+      all the storage is allocated up front, so a long chain of operations allocates nothing
+     */
+    class montgomery_modulus
+    {
+    public:
+        explicit montgomery_modulus(const numview m);
+
+        uint32_t n_limbs() const { return n; }
+
+        // 1 in montgomery form
+        const double_digit_t *one() const { return r.data(); }
+
+        // c = a*R mod m, for the non-negative a
+        void to_montgomery(double_digit_t *c, const numview a) const;
+
+        void multiply(double_digit_t *c, const double_digit_t *a, const double_digit_t *b) const;
+        void add(double_digit_t *c, const double_digit_t *a, const double_digit_t *b) const;
+        void subtract(double_digit_t *c, const double_digit_t *a, const double_digit_t *b) const;
+        // c = a/2 mod m
+        void halve(double_digit_t *c, const double_digit_t *a) const;
+
+        bool equal(const double_digit_t *a, const double_digit_t *b) const { return std::equal(a, a + n, b); }
+        bool is_zero(const double_digit_t *a) const;
+
+    private:
+        uint32_t n;
+        std::vector<double_digit_t> m;
+        double_digit_t m_inv; // -1/m mod 2^64
+        std::vector<double_digit_t> r;
+        std::vector<double_digit_t> r2;
+        mutable std::vector<double_digit_t> t; // n + 2 limbs of product accumulator
+    };
+
 } // namespace rqm
 
 #endif // RQM_BASIC_ARITHMETIC_H
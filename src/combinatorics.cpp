@@ -0,0 +1,164 @@
+#include "rqm/znum.h"
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "basic_arithmetic.h"
+
+namespace rqm
+{
+
+    // the odd primes up to n, by a sieve of eratosthenes over the odd numbers
+    [[nodiscard]] static std::vector<uint32_t> odd_primes_up_to(uint32_t n)
+    {
+        std::vector<uint32_t> primes;
+        if(n < 3) return primes;
+        // composite[i] is for 2i + 1
+        std::vector<bool> composite(n / 2 + 1);
+        for(uint64_t i = 1; 2 * i + 1 <= n; ++i)
+        {
+            if(composite[i]) continue;
+            uint64_t p = 2 * i + 1;
+            primes.push_back(uint32_t(p));
+            for(uint64_t multiple = p * p; multiple <= n; multiple += 2 * p)
+            {
+                composite[multiple / 2] = true;
+            }
+        }
+        return primes;
+    }
+
+    // collects factors, packing as many as fit into each 64-bit leaf, so that the tree starts with full-width numbers
+    class factor_collector
+    {
+    public:
+        void push(uint64_t factor, uint64_t count = 1)
+        {
+            for(uint64_t idx = 0; idx < count; ++idx)
+            {
+                if(current > UINT64_MAX / factor)
+                {
+                    leaves.push_back(current);
+                    current = 1;
+                }
+                current *= factor;
+            }
+        }
+
+        znum product()
+        {
+            if(current != 1) leaves.push_back(current);
+            current = 1;
+            return leaves.empty() ? znum::one() : product_tree(leaves.data(), leaves.data() + leaves.size());
+        }
+
+    private:
+        // balanced, so that the large multiplications are between operands of about the same size, where the fast multiplication tiers pay off
+        static znum product_tree(const uint64_t *first, const uint64_t *last)
+        {
+            if(last - first == 1) return znum::from_signum_magnitude(1, *first);
+            if(last - first == 2) return znum::from_signum_magnitude(1, quad_digit_t(first[0]) * first[1]);
+            const uint64_t *mid = first + (last - first) / 2;
+            return product_tree(first, mid) * product_tree(mid, last);
+        }
+
+        std::vector<uint64_t> leaves;
+        uint64_t current = 1;
+    };
+
+    // the exponent of the prime p in n!, by legendre's formula
+    [[nodiscard]] static uint64_t factorial_exponent(uint64_t n, uint64_t p)
+    {
+        uint64_t e = 0;
+        for(n /= p; n != 0; n /= p)
+        {
+            e += n;
+        }
+        return e;
+    }
+
+    /*
+      the odd part of n!, by the prime swing recursion. n! = (floor(n/2)!)^2 * swing(n), where the swing n!/(floor(n/2)!)^2 has each prime p
+      to the power of the number of odd floor(n/p^i), so it is a product of primes up to n with small exponents and comes straight from the sieve
+     */
+    [[nodiscard]] static znum odd_factorial(uint32_t n, const std::vector<uint32_t> &primes)
+    {
+        if(n < 3) return znum::one();
+
+        factor_collector swing;
+        for(uint32_t p: primes)
+        {
+            if(p > n) break;
+            uint64_t e = 0;
+            for(uint64_t q = n / p; q != 0; q /= p)
+            {
+                e += q & 1;
+            }
+            swing.push(p, e);
+        }
+        znum half = odd_factorial(n / 2, primes);
+        return half * half * swing.product();
+    }
+
+    znum factorial(uint32_t n)
+    {
+        // the power of two in n! is n - popcount(n), and goes on with a shift at the end
+        std::vector<uint32_t> primes = odd_primes_up_to(n);
+        return odd_factorial(n, primes) << (n - __builtin_popcount(n));
+    }
+
+    znum binomial(uint32_t n, uint32_t k)
+    {
+        if(k > n) return znum();
+        k = std::min(k, n - k);
+
+        // for small k, sieving up to n costs more than n (n - 1) ... (n - k + 1)/k! done directly
+        static constexpr uint32_t direct_binomial_threshold = 64;
+        if(k <= direct_binomial_threshold && n / 16 > k)
+        {
+            factor_collector product;
+            for(uint32_t idx = 0; idx < k; ++idx)
+            {
+                product.push(n - idx);
+            }
+            return product.product() / factorial(k);
+        }
+
+        // the exponent of p in n!/(k!(n-k)!) is the number of carries when adding k and n - k in base p, by kummer's theorem
+        factor_collector product;
+        product.push(2, factorial_exponent(n, 2) - factorial_exponent(k, 2) - factorial_exponent(n - k, 2));
+        for(uint32_t p: odd_primes_up_to(n))
+        {
+            product.push(p, factorial_exponent(n, p) - factorial_exponent(k, p) - factorial_exponent(n - k, p));
+        }
+        return product.product();
+    }
+
+    znum multinomial(const std::vector<uint32_t> &ks)
+    {
+        uint64_t n = 0;
+        for(uint32_t k: ks)
+        {
+            n += k;
+        }
+        if(n > UINT32_MAX) throw std::overflow_error("Multinomial too large");
+
+        // (k1 + k2 + ...)!/(k1! k2! ...), with the exponent of each prime from legendre's formula
+        factor_collector product;
+        std::vector<uint32_t> primes = odd_primes_up_to(n);
+        primes.insert(primes.begin(), 2);
+        for(uint32_t p: primes)
+        {
+            uint64_t e = factorial_exponent(n, p);
+            for(uint32_t k: ks)
+            {
+                if(k < p) continue;
+                e -= factorial_exponent(k, p);
+            }
+            product.push(p, e);
+        }
+        return product.product();
+    }
+
+} // namespace rqm
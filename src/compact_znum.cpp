@@ -0,0 +1,166 @@
+#include "rqm/compact_znum.h"
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <utility>
+
+#include "basic_arithmetic.h"
+#include "numview.h"
+#include "string_conversion.h"
+
+namespace rqm
+{
+
+    compact_znum::compact_znum(int64_t value)
+    {
+        _signum = compare_signum(value, int64_t(0));
+        uint64_t abs_value = value < 0 ? -uint64_t(value) : uint64_t(value);
+        is_stored_inline = true;
+        heap_capacity_log2 = 0;
+        u.digits_inline[0] = digit_t(abs_value);
+        u.digits_inline[1] = digit_t(abs_value >> n_bits_in_digit);
+        _n_digits = u.digits_inline[1] != 0 ? 2 : u.digits_inline[0] != 0 ? 1 : 0;
+    }
+
+    compact_znum::compact_znum(numview o)
+    {
+        _signum = o.signum;
+        digit_t *ptr = setup_storage(o.n_digits);
+        std::memcpy(ptr, o.digits, _n_digits * sizeof(digit_t));
+    }
+
+    compact_znum::compact_znum(const znum &o)
+        : compact_znum(o.to_numview())
+    {}
+
+    numview compact_znum::to_numview() const
+    {
+        return numview(_n_digits, _signum, digits());
+    }
+
+    znum compact_znum::to_znum() const
+    {
+        return znum(to_numview());
+    }
+
+    void compact_znum::update_signum_n_digits(numview o)
+    {
+        _signum = o.signum;
+        _n_digits = o.n_digits;
+        assert(digits() == o.digits);
+    }
+
+    compact_znum compact_znum::from_wide_magnitude(signum_t signum, quad_digit_t magnitude)
+    {
+        digit_t magnitude_digits[4];
+        for(uint32_t idx = 0; idx < 4; ++idx)
+        {
+            magnitude_digits[idx] = digit_t(magnitude >> (idx * n_bits_in_digit));
+        }
+        return compact_znum(remove_high_zeros(numview(4, signum, magnitude_digits)));
+    }
+
+    compact_znum add_general(const compact_znum &a, const compact_znum &b)
+    {
+        compact_znum c(compact_znum::empty_with_n_digits(), add_digit_estimate(a.n_digits(), b.n_digits()));
+        c.update_signum_n_digits(add(c.to_numview(), a.to_numview(), b.to_numview()));
+        return c;
+    }
+
+    compact_znum subtract_general(const compact_znum &a, const compact_znum &b)
+    {
+        compact_znum c(compact_znum::empty_with_n_digits(), add_digit_estimate(a.n_digits(), b.n_digits()));
+        c.update_signum_n_digits(add(c.to_numview(), a.to_numview(), negate(b.to_numview())));
+        return c;
+    }
+
+    compact_znum multiply_general(const compact_znum &a, const compact_znum &b)
+    {
+        compact_znum c(compact_znum::empty_with_n_digits(), multiply_digit_estimate(a.n_digits(), b.n_digits()));
+        c.update_signum_n_digits(multiply(c.to_numview(), a.to_numview(), b.to_numview()));
+        return c;
+    }
+
+    compact_znum operator-(const compact_znum &a)
+    {
+        compact_znum c = a;
+        return std::move(c.negate());
+    }
+
+    compact_znum abs(const compact_znum &a)
+    {
+        compact_znum c = a;
+        if(c.signum() < 0) c.negate();
+        return c;
+    }
+
+    compact_znum &compact_znum::operator+=(const compact_znum &o)
+    {
+        if(stored_inline() && o.fits_in_double_digit()) return *this = *this + o;
+        if(add_digit_estimate(_n_digits, o._n_digits) > capacity()) return *this = *this + o;
+
+        update_signum_n_digits(add(numview(mutable_digits()), to_numview(), o.to_numview()));
+        return *this;
+    }
+
+    compact_znum &compact_znum::operator-=(const compact_znum &o)
+    {
+        if(stored_inline() && o.fits_in_double_digit()) return *this = *this - o;
+        if(add_digit_estimate(_n_digits, o._n_digits) > capacity()) return *this = *this - o;
+
+        update_signum_n_digits(add(numview(mutable_digits()), to_numview(), rqm::negate(o.to_numview())));
+        return *this;
+    }
+
+    compact_znum &compact_znum::operator*=(const compact_znum &o)
+    {
+        return *this = *this * o;
+    }
+
+    signum_t compare(const compact_znum &a, const compact_znum &b)
+    {
+        return compare(a.to_numview(), b.to_numview());
+    }
+
+    bool operator==(const compact_znum &a, const compact_znum &b)
+    {
+        return compare(a, b) == 0;
+    }
+    bool operator!=(const compact_znum &a, const compact_znum &b)
+    {
+        return compare(a, b) != 0;
+    }
+    bool operator<(const compact_znum &a, const compact_znum &b)
+    {
+        return compare(a, b) < 0;
+    }
+    bool operator<=(const compact_znum &a, const compact_znum &b)
+    {
+        return compare(a, b) <= 0;
+    }
+    bool operator>(const compact_znum &a, const compact_znum &b)
+    {
+        return compare(a, b) > 0;
+    }
+    bool operator>=(const compact_znum &a, const compact_znum &b)
+    {
+        return compare(a, b) >= 0;
+    }
+
+    std::ostream &operator<<(std::ostream &os, const compact_znum &a)
+    {
+        uint32_t buf_size = to_string_buffer_estimate(a.n_digits());
+        scratch_space<char> buf(buf_size);
+        std::string_view sv = to_string(&buf[buf_size], a.to_numview());
+        return (os << sv);
+    }
+
+    std::string to_string(const compact_znum &a)
+    {
+        uint32_t buf_size = to_string_buffer_estimate(a.n_digits());
+        scratch_space<char> buf(buf_size);
+        std::string_view sv = to_string(&buf[buf_size], a.to_numview());
+        return std::string(sv);
+    }
+
+} // namespace rqm
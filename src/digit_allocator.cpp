@@ -0,0 +1,177 @@
+#include "rqm/digit_allocator.h"
+#include "rqm/compact_znum.h"
+#include "rqm/znum.h"
+#include <cstdint>
+
+namespace rqm
+{
+    static digit_t *new_allocate(uint8_t capacity_log2)
+    {
+        return new digit_t[size_t(1) << capacity_log2];
+    }
+
+    static void delete_deallocate(digit_t *ptr, uint8_t capacity_log2)
+    {
+        delete[] ptr;
+    }
+
+    digit_allocator new_delete_digit_allocator()
+    {
+        return digit_allocator{new_allocate, delete_deallocate};
+    }
+
+    // constant-initialised, so numbers created during static initialisation elsewhere can rely on it
+    static digit_allocator active_allocator = {new_allocate, delete_deallocate};
+
+    void set_digit_allocator(const digit_allocator &allocator)
+    {
+        active_allocator = allocator;
+    }
+
+    const digit_allocator &get_digit_allocator()
+    {
+        return active_allocator;
+    }
+
+    digit_t *znum::allocate_digits(uint8_t capacity_log2)
+    {
+        return active_allocator.allocate(capacity_log2);
+    }
+
+    void znum::deallocate_digits(digit_t *ptr, uint8_t capacity_log2)
+    {
+        active_allocator.deallocate(ptr, capacity_log2);
+    }
+
+    digit_t *compact_znum::allocate_digits(uint8_t capacity_log2)
+    {
+        return active_allocator.allocate(capacity_log2);
+    }
+
+    void compact_znum::deallocate_digits(digit_t *ptr, uint8_t capacity_log2)
+    {
+        active_allocator.deallocate(ptr, capacity_log2);
+    }
+
+    /*
+      The pool keeps an intrusive singly-linked free list per size class, with the link stored in the free block itself.
+      The smallest heap block holds more than n_inline_digits digits, which is plenty of room for a pointer.
+     */
+    namespace
+    {
+        struct free_block
+        {
+            free_block *next;
+        };
+
+        static constexpr uint32_t n_size_classes = 64;
+
+        struct digit_pool
+        {
+            free_block *free_lists[n_size_classes] = {};
+            uint32_t n_free[n_size_classes] = {};
+            digit_pool_statistics stats = {};
+
+            ~digit_pool();
+
+            void trim()
+            {
+                for(uint32_t size_class = 0; size_class < n_size_classes; ++size_class)
+                {
+                    while(free_block *block = free_lists[size_class])
+                    {
+                        free_lists[size_class] = block->next;
+                        delete[] reinterpret_cast<digit_t *>(block);
+                    }
+                    n_free[size_class] = 0;
+                }
+                stats.n_cached = 0;
+                stats.cached_bytes = 0;
+            }
+        };
+
+        // set when the pool of this thread has been torn down at thread exit. numbers outliving it fall back to plain delete[]
+        thread_local bool pool_destroyed = false;
+
+        digit_pool::~digit_pool()
+        {
+            trim();
+            pool_destroyed = true;
+        }
+
+        digit_pool &thread_pool()
+        {
+            thread_local digit_pool pool;
+            return pool;
+        }
+
+        size_t max_cached_blocks(uint8_t capacity_log2)
+        {
+            return max_pooled_bytes_per_size_class >> capacity_log2 >> 2; // 4 bytes per digit
+        }
+    } // namespace
+
+    static digit_t *pool_allocate(uint8_t capacity_log2)
+    {
+        if(!pool_destroyed)
+        {
+            digit_pool &pool = thread_pool();
+            if(free_block *block = pool.free_lists[capacity_log2])
+            {
+                pool.free_lists[capacity_log2] = block->next;
+                --pool.n_free[capacity_log2];
+                ++pool.stats.hits;
+                --pool.stats.n_cached;
+                pool.stats.cached_bytes -= sizeof(digit_t) << capacity_log2;
+                return reinterpret_cast<digit_t *>(block);
+            }
+            ++pool.stats.misses;
+        }
+        return new digit_t[size_t(1) << capacity_log2];
+    }
+
+    static void pool_deallocate(digit_t *ptr, uint8_t capacity_log2)
+    {
+        if(!pool_destroyed)
+        {
+            digit_pool &pool = thread_pool();
+            if(pool.n_free[capacity_log2] < max_cached_blocks(capacity_log2))
+            {
+                free_block *block = reinterpret_cast<free_block *>(ptr);
+                block->next = pool.free_lists[capacity_log2];
+                pool.free_lists[capacity_log2] = block;
+                ++pool.n_free[capacity_log2];
+                ++pool.stats.n_cached;
+                pool.stats.cached_bytes += sizeof(digit_t) << capacity_log2;
+                return;
+            }
+        }
+        delete[] ptr;
+    }
+
+    digit_allocator pooled_digit_allocator()
+    {
+        return digit_allocator{pool_allocate, pool_deallocate};
+    }
+
+    digit_pool_statistics get_digit_pool_statistics()
+    {
+        if(pool_destroyed) return digit_pool_statistics{};
+        return thread_pool().stats;
+    }
+
+    void reset_digit_pool_statistics()
+    {
+        if(pool_destroyed) return;
+        digit_pool &pool = thread_pool();
+        pool.stats.hits = 0;
+        pool.stats.misses = 0;
+    }
+
+    void trim_digit_pool()
+    {
+        if(pool_destroyed) return;
+        thread_pool().trim();
+    }
+
+} // namespace rqm
@@ -0,0 +1,53 @@
+#include "rqm/fixed_znum.h"
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include "basic_arithmetic.h"
+#include "numview.h"
+
+namespace rqm
+{
+    namespace detail
+    {
+        static numview fixed_view(signum_t signum, const digit_t *digits, uint32_t n_limbs)
+        {
+            return remove_high_zeros(numview(n_limbs, signum, digits));
+        }
+
+        static signum_t copy_padded(digit_t *digits, uint32_t n_limbs, numview v)
+        {
+            assert(v.n_digits <= n_limbs);
+            std::memcpy(digits, v.digits, v.n_digits * sizeof(digit_t));
+            std::memset(digits + v.n_digits, 0, (n_limbs - v.n_digits) * sizeof(digit_t));
+            return v.n_digits == 0 ? 0 : v.signum;
+        }
+
+        signum_t fixed_from_znum(digit_t *digits, uint32_t n_limbs, const znum &a)
+        {
+            numview v = a.to_numview();
+            if(v.n_digits > n_limbs) throw std::overflow_error("Out of range for a fixed_znum");
+            return copy_padded(digits, n_limbs, v);
+        }
+
+        znum fixed_to_znum(signum_t signum, const digit_t *digits, uint32_t n_limbs)
+        {
+            return znum(fixed_view(signum, digits, n_limbs));
+        }
+
+        void fixed_divmod(signum_t *quotient_signum, digit_t *quotient, signum_t *remainder_signum, digit_t *remainder, signum_t a_signum, const digit_t *a, signum_t b_signum,
+                          const digit_t *b, uint32_t n_limbs)
+        {
+            // the outputs are allowed to be the inputs, so divide into temporaries first
+            numview dividend = fixed_view(a_signum, a, n_limbs);
+            numview divisor = fixed_view(b_signum, b, n_limbs);
+            MAKE_TEMPORARY_NUMVIEW(q, quotient_digit_estimate(dividend.n_digits, divisor.n_digits));
+            MAKE_TEMPORARY_NUMVIEW(r, modulo_digit_estimate(dividend.n_digits, divisor.n_digits));
+            q = divmod(q, &r, dividend, divisor);
+
+            if(quotient != nullptr) *quotient_signum = copy_padded(quotient, n_limbs, q);
+            if(remainder != nullptr) *remainder_signum = copy_padded(remainder, n_limbs, r);
+        }
+    } // namespace detail
+
+} // namespace rqm
@@ -2,6 +2,7 @@
 #define RQM_DETAIL_NUMVIEW_H
 
 #include "rqm/digit.h"
+#include "scratch_arena.h"
 #include <cstddef>
 #include <cstdint>
 
@@ -37,9 +38,10 @@ namespace rqm
         digit_t *digits;
     };
 
-#define MAKE_STACK_TEMPORARY_NUMVIEW(name, n_digits)                                                                                                                                                   \
-    digit_t name##_storage[(n_digits)];                                                                                                                                                                \
-    numview name(name##_storage)
+    // a temporary number with room for n_digits digits, with storage from the scratch arena of the thread. released at the end of the enclosing scope
+#define MAKE_TEMPORARY_NUMVIEW(name, n_digits)                                                                                                                                                         \
+    scratch_space<digit_t> name##_storage(n_digits);                                                                                                                                                   \
+    numview name(name##_storage.data())
 
 } // namespace rqm
 
@@ -0,0 +1,311 @@
+#include "rqm/znum.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+#include "basic_arithmetic.h"
+#include "numview.h"
+
+namespace rqm
+{
+
+    // the odd primes below 1024 for trial division, grouped into runs whose products fit in a digit, so that one pass over the digits of a number
+    // gives its remainders by all of them
+    struct small_prime_table
+    {
+        small_prime_table()
+        {
+            for(uint32_t v = 3; v < 1024; v += 2)
+            {
+                bool prime = true;
+                for(uint32_t p: primes)
+                {
+                    if(p * p > v) break;
+                    if(v % p == 0) prime = false;
+                }
+                if(prime) primes.push_back(v);
+            }
+
+            uint64_t product = 1;
+            for(uint32_t idx = 0; idx < primes.size(); ++idx)
+            {
+                if(product * primes[idx] > UINT32_MAX)
+                {
+                    group_products.push_back(product);
+                    group_ends.push_back(idx);
+                    product = 1;
+                }
+                product *= primes[idx];
+            }
+            group_products.push_back(product);
+            group_ends.push_back(primes.size());
+        }
+
+        std::vector<uint32_t> primes;
+        std::vector<uint32_t> group_products;
+        std::vector<uint32_t> group_ends; // one past the last prime of each group
+    };
+
+    [[nodiscard]] static const small_prime_table &small_primes()
+    {
+        static const small_prime_table table;
+        return table;
+    }
+
+    // a mod each of the moduli, in a single pass over the digits of a, from the top
+    static void multi_remainder(uint32_t *remainders, const numview a, const std::vector<uint32_t> &moduli)
+    {
+        std::fill(remainders, remainders + moduli.size(), 0);
+        for(int32_t idx = a.n_digits - 1; idx >= 0; --idx)
+        {
+            for(size_t k = 0; k < moduli.size(); ++k)
+            {
+                remainders[k] = ((double_digit_t(remainders[k]) << n_bits_in_digit) | a.digits[idx]) % moduli[k];
+            }
+        }
+    }
+
+    enum class trial_division_result
+    {
+        composite,
+        prime,
+        undecided
+    };
+
+    [[nodiscard]] static trial_division_result trial_division(const znum &n)
+    {
+        if(n.signum() <= 0) return trial_division_result::composite;
+        const small_prime_table &table = small_primes();
+
+        // below 1024^2, every composite has a factor in the table
+        if(n.n_bits() <= 20)
+        {
+            uint32_t v = uint32_t(n.abs_double_digit());
+            if(v < 2) return trial_division_result::composite;
+            if(v == 2) return trial_division_result::prime;
+            if(v % 2 == 0) return trial_division_result::composite;
+            for(uint32_t p: table.primes)
+            {
+                if(p * p > v) break;
+                if(v % p == 0) return trial_division_result::composite;
+            }
+            return trial_division_result::prime;
+        }
+
+        if(!test_bit(n, 0)) return trial_division_result::composite;
+        std::vector<uint32_t> remainders(table.group_products.size());
+        multi_remainder(remainders.data(), n.to_numview(), table.group_products);
+        uint32_t prime_idx = 0;
+        for(uint32_t group = 0; group < remainders.size(); ++group)
+        {
+            for(; prime_idx < table.group_ends[group]; ++prime_idx)
+            {
+                if(remainders[group] % table.primes[prime_idx] == 0) return trial_division_result::composite;
+            }
+        }
+        return trial_division_result::undecided;
+    }
+
+    // c = base^exp mod m, all in montgomery form, for exp >= 1
+    static void pow_montgomery(const montgomery_modulus &mod, double_digit_t *c, const double_digit_t *base, const znum &exp)
+    {
+        std::copy(base, base + mod.n_limbs(), c);
+        for(int32_t bit = int32_t(exp.n_bits()) - 2; bit >= 0; --bit)
+        {
+            mod.multiply(c, c, c);
+            if(test_bit(exp, bit)) mod.multiply(c, c, base);
+        }
+    }
+
+    /*
+      the strong fermat test to the base b, for odd n > b. with n - 1 = d*2^s, a prime n has b^d = 1, or b^(d*2^r) = -1 for some r < s,
+      as the squares from b^d up to b^(n-1) = 1 can only reach 1 through -1
+     */
+    [[nodiscard]] static bool strong_fermat_test(const montgomery_modulus &mod, const znum &n_minus_one, digit_t b)
+    {
+        uint32_t n = mod.n_limbs();
+        scratch_space<double_digit_t> storage(3 * n);
+        double_digit_t *x = storage.data(), *base = x + n, *minus_one = base + n;
+        mod.to_montgomery(base, numview(1, 1, &b));
+        mod.to_montgomery(minus_one, n_minus_one.to_numview());
+
+        uint32_t s = countr_zero(n_minus_one);
+        pow_montgomery(mod, x, base, n_minus_one >> s);
+        if(mod.equal(x, mod.one()) || mod.equal(x, minus_one)) return true;
+        for(uint32_t r = 1; r < s; ++r)
+        {
+            mod.multiply(x, x, x);
+            if(mod.equal(x, minus_one)) return true;
+            if(mod.equal(x, mod.one())) return false;
+        }
+        return false;
+    }
+
+    // the jacobi symbol (a/n), for odd n
+    [[nodiscard]] static int32_t jacobi(uint64_t a, uint64_t n)
+    {
+        int32_t result = 1;
+        a %= n;
+        while(a != 0)
+        {
+            while(a % 2 == 0)
+            {
+                a /= 2;
+                if(n % 8 == 3 || n % 8 == 5) result = -result;
+            }
+            std::swap(a, n);
+            if(a % 4 == 3 && n % 4 == 3) result = -result;
+            a %= n;
+        }
+        return n == 1 ? result : 0;
+    }
+
+    // the jacobi symbol (d/n), for odd n and a small odd d, turned around by quadratic reciprocity into (n mod |d| / |d|)
+    [[nodiscard]] static int32_t jacobi(int32_t d, const znum &n)
+    {
+        uint32_t abs_d = std::abs(d);
+        uint32_t n_mod_4 = n.abs_double_digit() % 4;
+        int32_t result = jacobi(uint32_t(n % int32_t(abs_d)), abs_d);
+        if(abs_d % 4 == 3 && n_mod_4 == 3) result = -result;
+        if(d < 0 && n_mod_4 == 3) result = -result; // (-1/n)
+        return result;
+    }
+
+    // c = v mod m in montgomery form, for a small v. zero is n zero limbs
+    static void small_to_montgomery(const montgomery_modulus &mod, double_digit_t *c, int32_t v, const double_digit_t *zero)
+    {
+        digit_t magnitude = std::abs(v);
+        mod.to_montgomery(c, numview(1, 1, &magnitude));
+        if(v < 0) mod.subtract(c, zero, c);
+    }
+
+    /*
+      the strong lucas test with selfridge's parameters: D is the first of 5, -7, 9, -11, ... with (D/n) = -1, P = 1 and Q = (1 - D)/4.
+      with n + 1 = d*2^s, a prime n has U_d = 0, or V_(d*2^r) = 0 for some r < s. U and V are built up over the bits of d by
+      U_2k = U_k V_k, V_2k = V_k^2 - 2Q^k, and U_(k+1) = (U_k + V_k)/2, V_(k+1) = (D U_k + V_k)/2
+     */
+    [[nodiscard]] static bool strong_lucas_test(const montgomery_modulus &mod, const znum &n)
+    {
+        int32_t d = 5;
+        for(uint32_t attempt = 0;; ++attempt)
+        {
+            int32_t j = jacobi(d, n);
+            if(j == -1) break;
+            if(j == 0) return false; // n is larger than |d|, so this is a proper factor
+            // there's no such D for squares, so look for one when D is slow to come
+            if(attempt == 8 && is_perfect_square(n)) return false;
+            d = d > 0 ? -(d + 2) : -d + 2;
+        }
+
+        uint32_t n_limbs = mod.n_limbs();
+        scratch_space<double_digit_t> storage(7 * n_limbs);
+        double_digit_t *u = storage.data(), *v = u + n_limbs, *qk = v + n_limbs, *q = qk + n_limbs, *dm = q + n_limbs, *t = dm + n_limbs, *zero = t + n_limbs;
+        std::fill(zero, zero + n_limbs, 0);
+        small_to_montgomery(mod, q, (1 - d) / 4, zero);
+        small_to_montgomery(mod, dm, d, zero);
+
+        znum n_plus_one = n + 1;
+        uint32_t s = countr_zero(n_plus_one);
+        znum k = n_plus_one >> s;
+
+        // U_1 = 1, V_1 = P = 1
+        std::copy(mod.one(), mod.one() + n_limbs, u);
+        std::copy(mod.one(), mod.one() + n_limbs, v);
+        std::copy(q, q + n_limbs, qk);
+        for(int32_t bit = int32_t(k.n_bits()) - 2; bit >= 0; --bit)
+        {
+            mod.multiply(u, u, v);
+            mod.multiply(v, v, v);
+            mod.subtract(v, v, qk);
+            mod.subtract(v, v, qk);
+            mod.multiply(qk, qk, qk);
+            if(test_bit(k, bit))
+            {
+                mod.multiply(t, dm, u);
+                mod.add(u, u, v);
+                mod.halve(u, u);
+                mod.add(v, t, v);
+                mod.halve(v, v);
+                mod.multiply(qk, qk, q);
+            }
+        }
+        if(mod.is_zero(u) || mod.is_zero(v)) return true;
+
+        for(uint32_t r = 1; r < s; ++r)
+        {
+            mod.multiply(v, v, v);
+            mod.subtract(v, v, qk);
+            mod.subtract(v, v, qk);
+            if(mod.is_zero(v)) return true;
+            mod.multiply(qk, qk, qk);
+        }
+        return false;
+    }
+
+    // for odd n without small factors
+    [[nodiscard]] static bool passes_bpsw(const znum &n, uint32_t rounds)
+    {
+        montgomery_modulus mod(n.to_numview());
+        znum n_minus_one = n - 1;
+        if(!strong_fermat_test(mod, n_minus_one, 2) || !strong_lucas_test(mod, n)) return false;
+
+        const std::vector<uint32_t> &bases = small_primes().primes;
+        for(uint32_t idx = 0; idx < rounds && idx < bases.size(); ++idx)
+        {
+            if(!strong_fermat_test(mod, n_minus_one, bases[idx])) return false;
+        }
+        return true;
+    }
+
+    bool is_probable_prime(const znum &n, uint32_t rounds)
+    {
+        trial_division_result result = trial_division(n);
+        if(result != trial_division_result::undecided) return result == trial_division_result::prime;
+        return passes_bpsw(n, rounds);
+    }
+
+    znum next_prime(const znum &a)
+    {
+        if(a < 2) return 2;
+        znum candidate = a + (test_bit(a, 0) ? 2 : 1);
+        while(candidate.n_bits() <= 20)
+        {
+            if(is_probable_prime(candidate)) return candidate;
+            candidate += 2;
+        }
+
+        // past the table, sieve a window of odd candidates by the small primes at once, with one pass over the digits per window
+        static constexpr uint32_t window = 4096;
+        const small_prime_table &table = small_primes();
+        std::vector<uint32_t> remainders(table.group_products.size());
+        std::vector<bool> composite(window);
+        while(true)
+        {
+            multi_remainder(remainders.data(), candidate.to_numview(), table.group_products);
+            std::fill(composite.begin(), composite.end(), false);
+            uint32_t prime_idx = 0;
+            for(uint32_t group = 0; group < remainders.size(); ++group)
+            {
+                for(; prime_idx < table.group_ends[group]; ++prime_idx)
+                {
+                    // candidate + 2i is divisible by p for i = -r/2 mod p, and 1/2 = (p + 1)/2 mod p
+                    uint32_t p = table.primes[prime_idx];
+                    uint32_t r = remainders[group] % p;
+                    for(uint32_t idx = (p - r) % p * ((p + 1) / 2) % p; idx < window; idx += p)
+                    {
+                        composite[idx] = true;
+                    }
+                }
+            }
+            for(uint32_t idx = 0; idx < window; ++idx)
+            {
+                if(composite[idx]) continue;
+                znum c = candidate + int32_t(2 * idx);
+                if(passes_bpsw(c, 0)) return c;
+            }
+            candidate += int32_t(2 * window);
+        }
+    }
+
+} // namespace rqm
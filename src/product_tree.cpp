@@ -0,0 +1,105 @@
+#include "rqm/product_tree.h"
+#include <utility>
+#include <vector>
+
+namespace rqm
+{
+
+    product_tree::product_tree(const std::vector<znum> &leaves)
+        : levels{leaves}
+    {
+        // no leaves still makes a root, the empty product
+        if(leaves.empty()) levels.push_back({znum::one()});
+
+        while(levels.back().size() > 1)
+        {
+            const std::vector<znum> &below = levels.back();
+            std::vector<znum> level;
+            level.reserve((below.size() + 1) / 2);
+            for(size_t idx = 0; idx + 1 < below.size(); idx += 2)
+            {
+                level.push_back(below[idx] * below[idx + 1]);
+            }
+            if(below.size() % 2 != 0) level.push_back(below.back());
+            levels.push_back(std::move(level));
+        }
+    }
+
+    const znum &product_tree::product() const
+    {
+        return levels.back().front();
+    }
+
+    // r % m, skipping the division when r is already the shorter one
+    [[nodiscard]] static znum reduce(const znum &r, const znum &m)
+    {
+        if(r.n_bits() < m.n_bits()) return r;
+        return r % m;
+    }
+
+    std::vector<znum> product_tree::reduce_down(const znum &x, bool squares) const
+    {
+        if(empty()) return {};
+
+        // node idx on a level has its parent at idx/2, also for an odd one out carried up
+        std::vector<znum> current = {reduce(x, squares ? product() * product() : product())};
+        for(size_t level = levels.size() - 1; level-- > 0;)
+        {
+            const std::vector<znum> &nodes = levels[level];
+            std::vector<znum> next(nodes.size());
+            for(size_t idx = 0; idx < nodes.size(); ++idx)
+            {
+                next[idx] = reduce(current[idx / 2], squares ? nodes[idx] * nodes[idx] : nodes[idx]);
+            }
+            current = std::move(next);
+        }
+        return current;
+    }
+
+    std::vector<znum> product_tree::remainders(const znum &x) const
+    {
+        return reduce_down(x, false);
+    }
+
+    std::vector<znum> product_tree::remainders_of_squares(const znum &x) const
+    {
+        return reduce_down(x, true);
+    }
+
+    std::vector<znum> remainder_tree(const znum &x, const std::vector<znum> &moduli)
+    {
+        // nodes larger than x would leave it as it is, so the moduli go in runs with products about the size of x, each with a tree of its own
+        std::vector<znum> result;
+        result.reserve(moduli.size());
+        uint64_t x_bits = x.n_bits();
+        for(size_t first = 0; first < moduli.size();)
+        {
+            size_t last = first + 1;
+            uint64_t run_bits = moduli[first].n_bits();
+            while(last < moduli.size() && run_bits + moduli[last].n_bits() <= x_bits)
+            {
+                run_bits += moduli[last++].n_bits();
+            }
+            std::vector<znum> run(moduli.begin() + first, moduli.begin() + last);
+            for(znum &r: product_tree(run).remainders(x))
+            {
+                result.push_back(std::move(r));
+            }
+            first = last;
+        }
+        return result;
+    }
+
+    std::vector<znum> batch_gcd(const std::vector<znum> &numbers)
+    {
+        product_tree tree(numbers);
+        std::vector<znum> remainders = tree.remainders_of_squares(tree.product());
+        for(size_t idx = 0; idx < numbers.size(); ++idx)
+        {
+            // P mod n^2 is a multiple of n, and divided by it, it is the product of the others mod n
+            remainders[idx] = gcd(numbers[idx], remainders[idx] / numbers[idx]);
+        }
+        return remainders;
+    }
+
+} // namespace rqm
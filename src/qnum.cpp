@@ -4,7 +4,6 @@
 #include <istream>
 #include <limits>
 #include <ostream>
-#include <sstream>
 #include <stdexcept>
 #include <utility>
 
@@ -38,15 +37,94 @@ namespace rqm
             nominator = -nominator;
             denominator = -denominator;
         }
+        if(denominator.is_one()) return; // already canonical, and integer-valued accumulators are common enough to skip the gcd for
 
         znum gcd_val = gcd(nominator, denominator);
         if(!gcd_val.is_one())
         {
-            nominator = nominator / gcd_val;
-            denominator = denominator / gcd_val;
+            nominator /= gcd_val;
+            denominator /= gcd_val;
         }
     }
 
+    qnum &qnum::operator+=(const qnum &o)
+    {
+        if(denominator == o.denominator)
+        {
+            nominator += o.nominator;
+            canonicalize();
+        } else if(o.denominator.is_one())
+        {
+            // gcd(nom + o * denom, denom) = gcd(nom, denom) = 1, so we're still in canonical form
+            nominator += o.nominator * denominator;
+        } else
+        {
+            nominator *= o.denominator;
+            nominator += o.nominator * denominator;
+            denominator *= o.denominator;
+            canonicalize();
+        }
+        return *this;
+    }
+
+    qnum &qnum::operator-=(const qnum &o)
+    {
+        if(denominator == o.denominator)
+        {
+            nominator -= o.nominator;
+            canonicalize();
+        } else if(o.denominator.is_one())
+        {
+            nominator -= o.nominator * denominator;
+        } else
+        {
+            nominator *= o.denominator;
+            nominator -= o.nominator * denominator;
+            denominator *= o.denominator;
+            canonicalize();
+        }
+        return *this;
+    }
+
+    qnum &qnum::operator*=(const qnum &o)
+    {
+        nominator *= o.nominator;
+        denominator *= o.denominator;
+        canonicalize();
+        return *this;
+    }
+
+    qnum &qnum::operator*=(int32_t o)
+    {
+        nominator *= o;
+        canonicalize();
+        return *this;
+    }
+
+    qnum &qnum::operator/=(const qnum &o)
+    {
+        // throw before touching anything, so that a stays as it was
+        if(o.signum() == 0) throw std::out_of_range("divide by zero");
+        if(&o == this)
+        {
+            // we'd be reading the nominator after overwriting it, so work on a copy
+            qnum tmp = o;
+            return *this /= tmp;
+        }
+        nominator *= o.denominator;
+        denominator *= o.nominator;
+        canonicalize();
+        return *this;
+    }
+
+    qnum &qnum::operator/=(int32_t o)
+    {
+        if(o == 0) throw std::out_of_range("divide by zero");
+        denominator *= o;
+        canonicalize();
+        return *this;
+    }
+
     qnum qnum::from_double(double value)
     {
         if(std::isnan(value)) throw std::out_of_range("cannot represent NaN as a rational number");
@@ -110,17 +188,25 @@ namespace rqm
 
     qnum operator-(const qnum &a)
     {
-        return qnum(-a.nom(), a.denom());
+        // negating keeps the canonical form, so no need to go through the canonicalizing constructor
+        qnum c = a;
+        c.negate();
+        return c;
     }
 
     qnum operator+(const qnum &a, const qnum &b)
     {
-        return qnum(a.nom() * b.denom() + b.nom() * a.denom(), a.denom() * b.denom());
+        // the compound operator knows how to skip the cross multiplications and the gcd in the common cases
+        qnum c = a;
+        c += b;
+        return c;
     }
 
     qnum operator-(const qnum &a, const qnum &b)
     {
-        return a + (-b);
+        qnum c = a;
+        c -= b;
+        return c;
     }
 
     qnum operator*(const qnum &a, const qnum &b)
@@ -154,11 +240,71 @@ namespace rqm
         return os;
     }
 
+    qnum pow(const qnum &a, int64_t exp)
+    {
+        uint64_t abs_exp = exp < 0 ? uint64_t(0) - uint64_t(exp) : uint64_t(exp);
+        if(exp < 0 && a.signum() == 0) throw std::out_of_range("divide by zero");
+
+        znum nom = pow(a.nom(), abs_exp);
+        znum denom = pow(a.denom(), abs_exp);
+        if(exp >= 0) return qnum(std::move(nom), std::move(denom), qnum::already_canonical());
+
+        // the reciprocal, with the sign kept on the nominator
+        if(nom.signum() < 0)
+        {
+            nom.negate();
+            denom.negate();
+        }
+        return qnum(std::move(denom), std::move(nom), qnum::already_canonical());
+    }
+
+    std::istream &operator>>(std::istream &is, qnum &a)
+    {
+        znum nom;
+        if(!(is >> nom)) return is;
+        if(is.rdbuf()->sgetc() != '/')
+        {
+            a = qnum(std::move(nom));
+            return is;
+        }
+        is.rdbuf()->sbumpc();
+
+        // no whitespace is allowed after the slash
+        znum denom;
+        std::ios_base::fmtflags flags = is.flags();
+        is.unsetf(std::ios_base::skipws);
+        is >> denom;
+        is.flags(flags);
+        if(is.fail()) return is;
+        if(denom.signum() == 0)
+        {
+            is.setstate(std::ios_base::failbit);
+            return is;
+        }
+        a = qnum(std::move(nom), std::move(denom));
+        return is;
+    }
+
     std::string to_string(const qnum &a)
     {
-        std::stringstream ss;
-        ss << a;
-        return ss.str();
+        uint32_t buf_size = to_chars_max_size(a);
+        scratch_space<char> buf(buf_size);
+        std::to_chars_result res = to_chars(&buf[0], &buf[buf_size], a);
+        return std::string(&buf[0], res.ptr);
+    }
+
+    uint32_t to_chars_max_size(const qnum &a)
+    {
+        return to_chars_max_size(a.nom()) + 1 + to_chars_max_size(a.denom());
+    }
+
+    std::to_chars_result to_chars(char *first, char *last, const qnum &a)
+    {
+        std::to_chars_result res = to_chars(first, last, a.nom());
+        if(res.ec != std::errc()) return res;
+        if(res.ptr == last) return {last, std::errc::value_too_large};
+        *res.ptr++ = '/';
+        return to_chars(res.ptr, last, a.denom());
     }
 
     qnum qnum::from_string(const std::string_view sv)
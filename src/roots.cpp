@@ -0,0 +1,228 @@
+#include "rqm/znum.h"
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "basic_arithmetic.h"
+#include "numview.h"
+
+namespace rqm
+{
+
+    [[nodiscard]] static uint64_t isqrt_double_digit(double_digit_t v)
+    {
+        // the double is within a few units, and the exact square fixes it up
+        uint64_t r = uint64_t(std::sqrt(double(v)));
+        while(r > 0 && quad_digit_t(r) * r > v)
+        {
+            --r;
+        }
+        while(quad_digit_t(r + 1) * (r + 1) <= v)
+        {
+            ++r;
+        }
+        return r;
+    }
+
+    /*
+      square root and remainder of a non-negative n, by recursion on precision.
+      the root of the top half of n's bits, shifted up, is below the root of n by less than 2^s. one newton step from there lands at most a unit or two above it,
+      and the remainder corrects that. each level costs a division and a squaring of its own size, so the total is a constant times the top level
+     */
+    [[nodiscard]] static std::pair<znum, znum> sqrtrem_non_negative(const znum &n)
+    {
+        if(n.fits_in_double_digit())
+        {
+            double_digit_t v = n.abs_double_digit();
+            uint64_t r = isqrt_double_digit(v);
+            return {znum(int64_t(r)), znum::from_signum_magnitude(1, v - double_digit_t(r) * r)};
+        }
+
+        uint32_t s = n.n_bits() / 4;
+        znum x = sqrtrem_non_negative(n >> (2 * s)).first << s;
+        znum y = (x + n / x) >> 1;
+        znum rem = n - y * y;
+        while(rem.signum() < 0)
+        {
+            // (y - 1)^2 = y^2 - 2y + 1
+            rem += 2 * y - 1;
+            --y;
+        }
+        return {std::move(y), std::move(rem)};
+    }
+
+    std::pair<znum, znum> sqrtrem(const znum &a)
+    {
+        if(a.signum() < 0) throw std::domain_error("square root of a negative number");
+        return sqrtrem_non_negative(a);
+    }
+
+    znum isqrt(const znum &a)
+    {
+        return sqrtrem(a).first;
+    }
+
+    // an approximation of the k-th root of the positive n, good to about 50 bits, from the leading bits of n in floating point
+    [[nodiscard]] static znum iroot_estimate(const znum &n, uint32_t k)
+    {
+        uint32_t bits = n.n_bits();
+        uint32_t shift = bits > 64 ? bits - 64 : 0;
+        double log2_n = std::log2(double((n >> shift).abs_double_digit())) + shift;
+        double log2_root = log2_n / k;
+        if(log2_root < 60) return znum(int64_t(std::exp2(log2_root)) + 1);
+
+        uint32_t root_shift = uint32_t(log2_root) - 52;
+        return znum(int64_t(std::exp2(log2_root - root_shift)) + 1) << root_shift;
+    }
+
+    /*
+      the k-th root of the positive n by newton's method, x' = ((k - 1)x + n/x^(k - 1))/k. from above the root, the iterates fall towards it,
+      quadratically once close, until they stop falling. the start comes from the root of the top bits of n, found the same way with half the precision,
+      so most iterations run on small numbers
+     */
+    [[nodiscard]] static znum iroot_positive(const znum &n, uint32_t k)
+    {
+        uint32_t root_bits = n.n_bits() / k;
+        znum x;
+        if(root_bits < 100)
+        {
+            x = iroot_estimate(n, k);
+        } else
+        {
+            // cutting the low k*s bits of n off moves the root by less than 2^s, so this is just above it
+            uint32_t s = root_bits / 2;
+            x = (iroot_positive(n >> (k * s), k) + 1) << s;
+        }
+
+        // one step from anywhere positive lands on or above the root
+        znum k_minus_one = int64_t(k) - 1;
+        x = (k_minus_one * x + n / pow(x, k - 1)) / znum(k);
+        while(true)
+        {
+            znum y = (k_minus_one * x + n / pow(x, k - 1)) / znum(k);
+            if(y >= x) return x;
+            x = std::move(y);
+        }
+    }
+
+    znum iroot(const znum &a, uint32_t k)
+    {
+        if(k == 0) throw std::domain_error("zeroth root");
+        if(a.signum() < 0)
+        {
+            // odd roots of negative numbers truncate towards zero, like division
+            if(k % 2 == 0) throw std::domain_error("even root of a negative number");
+            return -iroot(-a, k);
+        }
+        if(k == 1 || a.signum() == 0) return a;
+        if(k == 2) return isqrt(a);
+        if(k >= a.n_bits()) return znum::one(); // 2^k > a
+        return iroot_positive(a, k);
+    }
+
+    // which residues modulo m are squares
+    template<uint32_t m>
+    static constexpr std::array<bool, m> square_residues()
+    {
+        std::array<bool, m> residues{};
+        for(uint32_t idx = 0; idx < m; ++idx)
+        {
+            residues[idx * idx % m] = true;
+        }
+        return residues;
+    }
+
+    bool is_perfect_square(const znum &a)
+    {
+        if(a.signum() < 0) return false;
+        if(a.signum() == 0) return true;
+
+        // squares are 12 of the 64 residues mod 64, 16 of 63, 21 of 65 and 6 of 11. together the filters let through fewer than 1 in 100 non-squares
+        static constexpr std::array<bool, 64> mod_64 = square_residues<64>();
+        static constexpr std::array<bool, 63> mod_63 = square_residues<63>();
+        static constexpr std::array<bool, 65> mod_65 = square_residues<65>();
+        static constexpr std::array<bool, 11> mod_11 = square_residues<11>();
+        if(!mod_64[a.abs_double_digit() % 64]) return false;
+        int32_t r = a % (63 * 65 * 11);
+        if(!mod_63[r % 63] || !mod_65[r % 65] || !mod_11[r % 11]) return false;
+
+        return sqrtrem_non_negative(a).second.signum() == 0;
+    }
+
+    [[nodiscard]] static bool is_small_prime(uint32_t v)
+    {
+        if(v < 2) return false;
+        for(uint32_t d = 2; d * d <= v; ++d)
+        {
+            if(v % d == 0) return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] static uint64_t powmod_small(uint64_t base, uint64_t exp, uint64_t modulus)
+    {
+        uint64_t result = 1;
+        for(base %= modulus; exp != 0; exp >>= 1)
+        {
+            if(exp & 1) result = result * base % modulus;
+            base = base * base % modulus;
+        }
+        return result;
+    }
+
+    // a p-th power is a p-th power residue modulo each prime q = 1 (mod p), and only about 1 in p residues are. a few such q reject nearly every non-power
+    [[nodiscard]] static bool passes_power_residue_filter(const znum &n, uint32_t p)
+    {
+        uint32_t n_checked = 0;
+        for(uint64_t q = 2 * uint64_t(p) + 1; n_checked < 4 && q < INT32_MAX; q += 2 * p)
+        {
+            if(!is_small_prime(q)) continue;
+            ++n_checked;
+            int32_t r = n % int32_t(q);
+            if(r != 0 && powmod_small(r, (q - 1) / p, q) != 1) return false;
+        }
+        return true;
+    }
+
+    bool is_perfect_power(const znum &a)
+    {
+        // 0 and 1 are squares, and -1 is a cube
+        znum n = abs(a);
+        if(n <= 1) return true;
+        if(a.signum() > 0 && is_perfect_square(n)) return true;
+
+        // in n = m^k, the power of two in n is a multiple of k
+        uint32_t n_twos = countr_zero(n);
+        if(n_twos == 1) return false;
+
+        // for the large exponents, the root is small enough to come from floating point. log2(n) is off by a few ulps, and that scales to an error of
+        // about root_bits * 2^(root_bits - 50) in the root, well below one unit for roots under 32 bits. the candidates are checked modulo a prime before the full check
+        uint32_t bits = n.n_bits();
+        uint32_t shift = bits > 64 ? bits - 64 : 0;
+        double log2_n = std::log2(double((n >> shift).abs_double_digit())) + shift;
+        static constexpr uint32_t check_prime = 2147483647;
+        uint64_t n_mod_check_prime = uint32_t(n % int32_t(check_prime));
+
+        // the remaining candidates are the odd prime exponents, as m^(pq) = (m^q)^p. negative numbers can only be odd powers
+        for(uint32_t p = 3; p < bits; p += 2)
+        {
+            if((n_twos != 0 && n_twos % p != 0) || !is_small_prime(p)) continue;
+            double log2_root = log2_n / p;
+            if(log2_root < 32)
+            {
+                int64_t root = std::llround(std::exp2(log2_root));
+                for(int64_t candidate = std::max<int64_t>(2, root - 1); candidate <= root + 1; ++candidate)
+                {
+                    if(powmod_small(candidate, p, check_prime) == n_mod_check_prime && pow(znum(candidate), p) == n) return true;
+                }
+                continue;
+            }
+            if(!passes_power_residue_filter(n, p)) continue;
+            if(pow(iroot_positive(n, p), p) == n) return true;
+        }
+        return false;
+    }
+
+} // namespace rqm
@@ -0,0 +1,21 @@
+#include "scratch_arena.h"
+
+namespace rqm
+{
+
+    void *scratch_arena::allocate_in_next_chunk(size_t n_bytes)
+    {
+        // the rest of the current chunk goes unused until we're released back past this point
+        if(current_chunk < chunks.size())
+        {
+            ++current_chunk;
+        }
+        if(current_chunk == chunks.size())
+        {
+            chunks.emplace_back(new char[chunk_size]);
+        }
+        offset = n_bytes;
+        return chunks[current_chunk].get();
+    }
+
+} // namespace rqm
@@ -0,0 +1,117 @@
+#ifndef RQM_DETAIL_SCRATCH_ARENA_H
+#define RQM_DETAIL_SCRATCH_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rqm
+{
+
+    /**
+       A per-thread bump-pointer arena for the temporaries of the kernels.
+
+       Memory comes in fixed-size chunks that are kept around for the lifetime of the thread, so once the arena has warmed up,
+       temporaries cost a pointer bump and recursive algorithms don't go back to the heap for every level.
+       Allocations are released in LIFO order, by restoring a previously taken mark. scratch_space below takes care of that.
+     */
+    class scratch_arena
+    {
+    public:
+        static constexpr size_t chunk_size = 256 * 1024;
+        static constexpr size_t alignment = alignof(std::max_align_t);
+
+        struct position
+        {
+            size_t chunk;
+            size_t offset;
+        };
+
+        static scratch_arena &for_this_thread()
+        {
+            thread_local scratch_arena arena;
+            return arena;
+        }
+
+        position mark() const { return position{current_chunk, offset}; }
+        void release(position p)
+        {
+            current_chunk = p.chunk;
+            offset = p.offset;
+        }
+
+        // n_bytes must be at most chunk_size
+        void *allocate(size_t n_bytes)
+        {
+            n_bytes = (n_bytes + alignment - 1) & ~(alignment - 1);
+            if(current_chunk < chunks.size() && offset + n_bytes <= chunk_size)
+            {
+                void *ptr = chunks[current_chunk].get() + offset;
+                offset += n_bytes;
+                return ptr;
+            }
+            return allocate_in_next_chunk(n_bytes);
+        }
+
+    private:
+        void *allocate_in_next_chunk(size_t n_bytes);
+
+        std::vector<std::unique_ptr<char[]>> chunks;
+        size_t current_chunk = 0;
+        size_t offset = 0;
+    };
+
+    /**
+       Scoped temporary storage for n elements of T.
+       Tiny requests live in a small fixed-size buffer inside the object itself, which keeps the common small-number case off the arena entirely.
+       Medium requests are carved out of the scratch arena of the thread, and handed back when this goes out of scope.
+       Anything larger than an arena chunk falls back to the heap, so huge numbers never put large temporaries on the stack
+     */
+    template<typename T>
+    class scratch_space
+    {
+    public:
+        static constexpr size_t n_local_bytes = 64;
+
+        explicit scratch_space(size_t n)
+        {
+            size_t n_bytes = n * sizeof(T);
+            if(n_bytes <= n_local_bytes)
+            {
+                ptr = reinterpret_cast<T *>(local_storage);
+            } else if(n_bytes <= scratch_arena::chunk_size)
+            {
+                arena = &scratch_arena::for_this_thread();
+                arena_mark = arena->mark();
+                ptr = static_cast<T *>(arena->allocate(n_bytes));
+            } else
+            {
+                heap_storage.reset(new T[n]);
+                ptr = heap_storage.get();
+            }
+        }
+
+        ~scratch_space()
+        {
+            if(arena != nullptr) arena->release(arena_mark);
+        }
+
+        // releases happen in LIFO order, so these must stay put
+        scratch_space(const scratch_space &) = delete;
+        scratch_space &operator=(const scratch_space &) = delete;
+
+        T *data() { return ptr; }
+        T &operator[](size_t idx) { return ptr[idx]; }
+
+    private:
+        T *ptr;
+        scratch_arena *arena = nullptr;
+        scratch_arena::position arena_mark;
+        std::unique_ptr<T[]> heap_storage;
+        alignas(std::max_align_t) char local_storage[n_local_bytes];
+    };
+
+} // namespace rqm
+
+#endif // RQM_DETAIL_SCRATCH_ARENA_H
@@ -0,0 +1,155 @@
+#include "rqm/qnum.h"
+#include "rqm/znum.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "numview.h"
+
+namespace rqm
+{
+    /*
+      The binary format of a znum is a header followed by the digits.
+      The header is a LEB128 varint of n_digits << 3 | version << 1 | negative, in its shortest form, so numbers of up to 15 digits get a one-byte header.
+      The digits follow as little-endian 32-bit words, least significant first, with the most significant one non-zero. Zero is just the header.
+      A qnum is its nominator followed by its denominator.
+     */
+    static constexpr uint64_t serialization_version = 0;
+
+    [[nodiscard]] static size_t varint_size(uint64_t v)
+    {
+        size_t n = 1;
+        while(v >= 0x80)
+        {
+            v >>= 7;
+            ++n;
+        }
+        return n;
+    }
+
+    [[nodiscard]] static std::byte *write_varint(std::byte *pos, uint64_t v)
+    {
+        while(v >= 0x80)
+        {
+            *pos++ = std::byte((v & 0x7f) | 0x80);
+            v >>= 7;
+        }
+        *pos++ = std::byte(v);
+        return pos;
+    }
+
+    [[nodiscard]] static uint64_t read_varint(const std::byte *&pos, const std::byte *end)
+    {
+        uint64_t v = 0;
+        for(uint32_t shift = 0; shift < 64; shift += 7)
+        {
+            if(pos == end) throw std::invalid_argument("Malformed serialized number");
+            uint64_t b = uint64_t(*pos++);
+            // each value has a single encoding: no zero byte at the end of a longer varint, and no bits above the 64th
+            if(shift == 63 && b > 1) break;
+            v |= (b & 0x7f) << shift;
+            if((b & 0x80) == 0)
+            {
+                if(b == 0 && shift != 0) break;
+                return v;
+            }
+        }
+        throw std::invalid_argument("Malformed serialized number");
+    }
+
+    [[nodiscard]] static uint64_t serialization_header(const znum &a)
+    {
+        return uint64_t(a.n_digits()) << 3 | serialization_version << 1 | uint64_t(a.signum() < 0);
+    }
+
+    size_t serialized_size(const znum &a)
+    {
+        return varint_size(serialization_header(a)) + size_t(a.n_digits()) * sizeof(digit_t);
+    }
+
+    std::byte *serialize(std::byte *first, std::byte *last, const znum &a)
+    {
+        if(size_t(last - first) < serialized_size(a)) throw std::length_error("Buffer too small to serialize into");
+        first = write_varint(first, serialization_header(a));
+
+        numview v = a.to_numview();
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        memcpy(first, v.digits, v.n_digits * sizeof(digit_t));
+        first += v.n_digits * sizeof(digit_t);
+#else
+        for(uint32_t idx = 0; idx < v.n_digits; ++idx)
+        {
+            for(uint32_t byte_idx = 0; byte_idx < sizeof(digit_t); ++byte_idx)
+            {
+                *first++ = std::byte(v.digits[idx] >> (8 * byte_idx));
+            }
+        }
+#endif
+        return first;
+    }
+
+    znum znum::deserialize(const std::byte *&pos, const std::byte *end)
+    {
+        const std::byte *p = pos;
+        uint64_t header = read_varint(p, end);
+        uint64_t n_digits64 = header >> 3;
+        bool negative = (header & 1) != 0;
+        if(((header >> 1) & 3) != serialization_version) throw std::invalid_argument("Unsupported serialization version");
+        if(n_digits64 > size_t(end - p) / sizeof(digit_t) || n_digits64 > std::numeric_limits<uint32_t>::max()) throw std::invalid_argument("Malformed serialized number");
+        uint32_t n_digits = uint32_t(n_digits64);
+        if(n_digits == 0)
+        {
+            if(negative) throw std::invalid_argument("Malformed serialized number");
+            pos = p;
+            return znum();
+        }
+
+        // one allocation of the right size, and the digits go straight in
+        znum c(znum::empty_with_n_digits(), n_digits);
+        numview v = c.to_numview();
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        memcpy(v.digits, p, n_digits * sizeof(digit_t));
+#else
+        for(uint32_t idx = 0; idx < n_digits; ++idx)
+        {
+            digit_t d = 0;
+            for(uint32_t byte_idx = 0; byte_idx < sizeof(digit_t); ++byte_idx)
+            {
+                d |= digit_t(p[idx * sizeof(digit_t) + byte_idx]) << (8 * byte_idx);
+            }
+            v.digits[idx] = d;
+        }
+#endif
+        if(v.digits[n_digits - 1] == 0) throw std::invalid_argument("Malformed serialized number");
+        v.signum = negative ? -1 : 1;
+        c.update_signum_n_digits(v);
+        pos = p + n_digits * sizeof(digit_t);
+        return c;
+    }
+
+    size_t serialized_size(const qnum &a)
+    {
+        return serialized_size(a.nom()) + serialized_size(a.denom());
+    }
+
+    std::byte *serialize(std::byte *first, std::byte *last, const qnum &a)
+    {
+        if(size_t(last - first) < serialized_size(a)) throw std::length_error("Buffer too small to serialize into");
+        first = serialize(first, last, a.nom());
+        return serialize(first, last, a.denom());
+    }
+
+    qnum qnum::deserialize(const std::byte *&pos, const std::byte *end)
+    {
+        const std::byte *p = pos;
+        znum nom = znum::deserialize(p, end);
+        znum denom = znum::deserialize(p, end);
+        if(denom.signum() <= 0) throw std::invalid_argument("Malformed serialized number");
+        pos = p;
+        // serialize only ever writes canonical pairs, so there's no need for a gcd here
+        return qnum(std::move(nom), std::move(denom), already_canonical());
+    }
+
+} // namespace rqm
@@ -5,7 +5,11 @@
 #include <cassert>
 #include <charconv>
 #include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
 #include <string_view>
+#include <vector>
 
 namespace rqm
 {
@@ -16,53 +20,212 @@ namespace rqm
         return pos;
     }
 
-    [[nodiscard]] std::string_view to_string(char *end, const numview n)
+    static constexpr char radix_chars[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+    // the value of a character in any base up to 36, upper and lower case alike. anything else gets a value too large for every base
+    [[nodiscard]] static inline digit_t radix_char_value(char c)
     {
-        if(n.signum == 0) return std::string_view("0"); // special-case zeros
+        if(c >= '0' && c <= '9') return c - '0';
+        if(c >= 'a' && c <= 'z') return c - 'a' + 10;
+        if(c >= 'A' && c <= 'Z') return c - 'A' + 10;
+        return 36;
+    }
 
-        // fast path single-digit value
-        if(n.n_digits == 1)
+    // everything the general conversions need to know about a base. values are converted a chunk of chars_per_digit characters at a time
+    struct radix
+    {
+        constexpr radix(uint32_t _base)
+            : base(_base),
+              chars_per_digit(n_chars_in_digit_low(_base)),
+              chunk_modulus(1)
         {
-            signed_double_digit_t v = signed_double_digit_t(n.digits[0]) * n.signum;
-            uint32_t max_possible = to_string_buffer_estimate(1);
-            char *pos = end - max_possible;
-            int n_written = snprintf(pos, max_possible, "%lld", v);
-            return std::string_view(pos, n_written);
+            for(uint32_t idx = 0; idx < chars_per_digit; ++idx)
+            {
+                chunk_modulus *= base;
+            }
         }
 
-        MAKE_STACK_TEMPORARY_NUMVIEW(value, n.n_digits);
-        MAKE_STACK_TEMPORARY_NUMVIEW(value2, n.n_digits);
+        digit_t base;
+        uint32_t chars_per_digit;
+        digit_t chunk_modulus; // base^chars_per_digit. wraps to zero for the power-of-two bases, which don't go through chunks
+    };
 
-        memcpy(value.digits, n.digits, n.n_digits * sizeof(n.digits[0]));
-        value.signum = 1; // it's positive now. negativeness is handled at the end
-        value.n_digits = n.n_digits;
+    static constexpr radix decimal_radix(10);
 
-        char *pos = end;
+    // for bases that are powers of two, the number of bits per character. zero otherwise
+    [[nodiscard]] static uint32_t bits_per_radix_char(uint32_t base)
+    {
+        return (base & (base - 1)) == 0 ? __builtin_ctz(base) : 0;
+    }
+
+    // "00" to "99" back to back, so that decimals come out two at a time with one division by 100
+    static constexpr char decimal_pairs[] = "00010203040506070809"
+                                            "10111213141516171819"
+                                            "20212223242526272829"
+                                            "30313233343536373839"
+                                            "40414243444546474849"
+                                            "50515253545556575859"
+                                            "60616263646566676869"
+                                            "70717273747576777879"
+                                            "80818283848586878889"
+                                            "90919293949596979899";
+
+    // writes the nine decimals of v < 10^9 with leading zeros, ending at end, and returns where they start
+    [[nodiscard]] static char *format_nine_decimals(char *end, digit_t v)
+    {
+        for(uint32_t idx = 0; idx < n_decimals_in_digit_low / 2; ++idx)
+        {
+            end -= 2;
+            memcpy(end, &decimal_pairs[2 * (v % 100)], 2);
+            v /= 100;
+        }
+        *--end = char('0' + v);
+        return end;
+    }
+
+    // writes the decimals of v without leading zeros, ending at end, and returns where they start
+    [[nodiscard]] static char *format_decimals_unpadded(char *end, double_digit_t v)
+    {
+        while(v >= 100)
+        {
+            end -= 2;
+            memcpy(end, &decimal_pairs[2 * (v % 100)], 2);
+            v /= 100;
+        }
+        if(v >= 10)
+        {
+            end -= 2;
+            memcpy(end, &decimal_pairs[2 * v], 2);
+        } else
+        {
+            *--end = char('0' + v);
+        }
+        return end;
+    }
+
+    // writes a chunk v < chunk_modulus ending at end, and returns where it starts. either padded with leading zeros to chars_per_digit characters, or without any
+    [[nodiscard]] static char *format_chunk(char *end, digit_t v, const radix &r, bool padded)
+    {
+        if(r.base == 10) return padded ? format_nine_decimals(end, v) : format_decimals_unpadded(end, v);
+
+        char *start = end - r.chars_per_digit;
+        do
+        {
+            *--end = radix_chars[v % r.base];
+            v /= r.base;
+        } while(v != 0);
+        while(padded && end > start)
+        {
+            *--end = '0';
+        }
+        return end;
+    }
+
+    // below this many digits, peeling off a chunk at a time with single-digit divisions beats dividing by large powers of the base
+    static constexpr uint32_t to_string_divide_threshold = 30;
+
+    // chunk_modulus^(2^k), built by repeated squaring on first use and kept for the lifetime of the thread. shared by to_string and from_chars
+    [[nodiscard]] static numview power_for_split(const radix &r, uint32_t k)
+    {
+        thread_local std::vector<std::vector<digit_t>> powers_by_base[37];
+        std::vector<std::vector<digit_t>> &powers = powers_by_base[r.base];
+        if(powers.empty()) powers.push_back({r.chunk_modulus});
+        while(powers.size() <= k)
+        {
+            const std::vector<digit_t> &prev = powers.back();
+            numview p(prev.size(), 1, prev.data());
+            std::vector<digit_t> next(multiply_digit_estimate(p.n_digits, p.n_digits));
+            numview square = multiply(numview(next.size(), 0, next.data()), p, p);
+            next.resize(square.n_digits);
+            powers.push_back(std::move(next));
+        }
+        return numview(powers[k].size(), 1, powers[k].data());
+    }
+
+    // writes the non-negative value v so that it ends at end, and returns where it starts.
+    // with a non-zero pad_to, the output is zero-padded to exactly pad_to characters
+    [[nodiscard]] static char *format_radix_basecase(char *end, const numview v, const radix &r, uint32_t pad_to)
+    {
+        MAKE_TEMPORARY_NUMVIEW(value, v.n_digits);
+        MAKE_TEMPORARY_NUMVIEW(value2, v.n_digits);
+        value = copy_view(value, v);
 
+        char *pos = end;
         while(value.n_digits > 0)
         {
             digit_t value_to_format;
 
-            value2 = abs_divmod_by_single_digit(value2, &value_to_format, value, decimal_digit_modulus);
+            value2 = abs_divmod_by_single_digit(value2, &value_to_format, value, r.chunk_modulus);
             std::swap(value, value2);
 
             // value_to_format holds the remainder for this division. format it.
-            char buf[n_decimals_in_digit_low + 1];
-            int n_chars_written;
-            if(value.n_digits > 0)
-            {
-                // there's more left. make sure we have 9 characters with leading zeros if necessary
-                n_chars_written = snprintf(buf, n_decimals_in_digit_low + 1, "%09u", value_to_format);
-            } else
-            {
-                // just the actual non-zero values, please
-                n_chars_written = snprintf(buf, n_decimals_in_digit_low + 1, "%u", value_to_format);
-            }
-            pos -= n_chars_written;
-            memcpy(pos, buf, n_chars_written);
+            // if there's more left, make sure we have all the characters with leading zeros. otherwise just the actual non-zero values, please
+            pos = format_chunk(pos, value_to_format, r, value.n_digits > 0 || pad_to > 0);
         }
 
-        pos = chomp_leading_zeros(pos);
+        while(pos > end - pad_to)
+        {
+            *--pos = '0';
+        }
+        return pos;
+    }
+
+    // divide and conquer: split v by the cached power of the base with about half its digits, then format the remainder zero-padded below the quotient.
+    // with fast division, this is subquadratic, where the base case alone is quadratic
+    [[nodiscard]] static char *format_radix(char *end, const numview v, const radix &r, uint32_t pad_to)
+    {
+        if(v.n_digits < to_string_divide_threshold) return format_radix_basecase(end, v, r, pad_to);
+
+        uint32_t k = 0;
+        while(2 * power_for_split(r, k + 1).n_digits <= v.n_digits + 1)
+        {
+            ++k;
+        }
+        numview power = power_for_split(r, k);
+        uint32_t n_low_chars = r.chars_per_digit << k;
+
+        MAKE_TEMPORARY_NUMVIEW(high, quotient_digit_estimate(v.n_digits, power.n_digits));
+        MAKE_TEMPORARY_NUMVIEW(low, modulo_digit_estimate(v.n_digits, power.n_digits));
+        high = divmod(high, &low, v, power);
+
+        char *pos = format_radix(end, low, r, n_low_chars);
+        return format_radix(pos, high, r, pad_to > n_low_chars ? pad_to - n_low_chars : 0);
+    }
+
+    // for bases that are powers of two, every character is a fixed group of bits, so this is linear time. v is non-negative and non-zero
+    [[nodiscard]] static char *format_power_of_two(char *end, const numview v, uint32_t bits_per_char)
+    {
+        uint32_t n_chars = cdiv(n_bits(v), bits_per_char);
+        digit_t mask = (digit_t(1) << bits_per_char) - 1;
+        for(uint32_t idx = 0; idx < n_chars; ++idx)
+        {
+            // a character can straddle two digits
+            uint32_t bit = idx * bits_per_char;
+            uint32_t digit_idx = bit / n_bits_in_digit;
+            double_digit_t bits = v.digits[digit_idx];
+            if(digit_idx + 1 < v.n_digits) bits |= double_digit_t(v.digits[digit_idx + 1]) << n_bits_in_digit;
+            *--end = radix_chars[(bits >> (bit % n_bits_in_digit)) & mask];
+        }
+        return end;
+    }
+
+    [[nodiscard]] std::string_view to_string(char *end, const numview n, uint32_t base)
+    {
+        if(n.signum == 0) return std::string_view("0"); // special-case zeros
+
+        char *pos;
+        if(uint32_t bits_per_char = bits_per_radix_char(base); bits_per_char != 0)
+        {
+            pos = format_power_of_two(end, abs(n), bits_per_char);
+        } else if(n.n_digits == 1 && base == 10)
+        {
+            // fast path single-digit value
+            pos = format_decimals_unpadded(end, n.digits[0]);
+        } else
+        {
+            pos = format_radix(end, abs(n), base == 10 ? decimal_radix : radix(base), 0); // negativeness is handled at the end
+            pos = chomp_leading_zeros(pos);
+        }
 
         if(n.signum < 0)
         {
@@ -71,9 +234,231 @@ namespace rqm
         return std::string_view(pos, end - pos);
     }
 
-    // from_chars converts a numeric string in base-10 to a numview.
-    // we take two buffers, dest1 and dest2, and may use either of them for the destination
-    [[nodiscard]] numview from_chars(numview dest, const char *pos, const char *end)
+    // collects characters in a fixed-size buffer, and hands them to the stream whenever it fills up
+    class chunked_writer
+    {
+    public:
+        explicit chunked_writer(std::ostream &_os)
+            : os(_os)
+        {}
+
+        void write(const char *pos, const char *end)
+        {
+            while(pos < end)
+            {
+                size_t n = std::min<size_t>(end - pos, sizeof(buf) - n_buffered);
+                memcpy(buf + n_buffered, pos, n);
+                n_buffered += n;
+                pos += n;
+                if(n_buffered == sizeof(buf)) flush();
+            }
+        }
+
+        void fill(char c, size_t n)
+        {
+            while(n > 0)
+            {
+                size_t n_fill = std::min<size_t>(n, sizeof(buf) - n_buffered);
+                memset(buf + n_buffered, c, n_fill);
+                n_buffered += n_fill;
+                n -= n_fill;
+                if(n_buffered == sizeof(buf)) flush();
+            }
+        }
+
+        void flush()
+        {
+            os.write(buf, n_buffered);
+            n_buffered = 0;
+        }
+
+    private:
+        std::ostream &os;
+        char buf[4096];
+        size_t n_buffered = 0;
+    };
+
+    // the same split as format_radix, but the high part goes first, so that the characters come out in order
+    static void write_radix(chunked_writer &out, const numview v, const radix &r, uint32_t pad_to)
+    {
+        if(v.n_digits < to_string_divide_threshold)
+        {
+            char buf[to_string_buffer_estimate(to_string_divide_threshold)];
+            char *end = buf + sizeof(buf);
+            char *pos = format_radix_basecase(end, v, r, 0);
+            if(uint32_t(end - pos) < pad_to) out.fill('0', pad_to - (end - pos));
+            out.write(pos, end);
+            return;
+        }
+
+        uint32_t k = 0;
+        while(2 * power_for_split(r, k + 1).n_digits <= v.n_digits + 1)
+        {
+            ++k;
+        }
+        numview power = power_for_split(r, k);
+        uint32_t n_low_chars = r.chars_per_digit << k;
+
+        MAKE_TEMPORARY_NUMVIEW(high, quotient_digit_estimate(v.n_digits, power.n_digits));
+        MAKE_TEMPORARY_NUMVIEW(low, modulo_digit_estimate(v.n_digits, power.n_digits));
+        high = divmod(high, &low, v, power);
+
+        write_radix(out, high, r, pad_to > n_low_chars ? pad_to - n_low_chars : 0);
+        write_radix(out, low, r, n_low_chars);
+    }
+
+    void write_decimal(std::ostream &os, const numview n)
+    {
+        chunked_writer out(os);
+        if(n.signum == 0)
+        {
+            out.fill('0', 1);
+        } else
+        {
+            if(n.signum < 0) out.fill('-', 1);
+            write_radix(out, abs(n), decimal_radix, 0);
+        }
+        out.flush();
+    }
+
+    numview decimal_split_power(uint32_t k)
+    {
+        return power_for_split(decimal_radix, k);
+    }
+
+    static constexpr digit_t powers_of_ten[n_decimals_in_digit_low + 1] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+    // the value of the eight decimals at pos, checking and converting all of them at once with SWAR tricks in a 64-bit register.
+    // returns false if any of them isn't a decimal
+    [[nodiscard]] static inline bool parse_eight_decimals(const char *pos, digit_t *value)
+    {
+        uint64_t v;
+        memcpy(&v, pos, sizeof(v));
+        // every byte must be 0x30 to 0x39: the high nibble is 3, and adding 6 doesn't carry out of the low nibble
+        if((v & 0xf0f0f0f0f0f0f0f0) != 0x3030303030303030 || ((v + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) != 0x3030303030303030) return false;
+        v -= 0x3030303030303030;
+        // the first character lands in the lowest byte. combine neighbouring decimals into pairs, then the pairs into the full value
+        v = v * 10 + (v >> 8);
+        v = ((v & 0x000000ff000000ff) * (100 + (uint64_t(1000000) << 32)) + ((v >> 16) & 0x000000ff000000ff) * (1 + (uint64_t(10000) << 32))) >> 32;
+        *value = digit_t(v);
+        return true;
+    }
+
+    // the value of up to nine decimals at pos. throws if any of them isn't a decimal
+    [[nodiscard]] static digit_t parse_decimal_chunk(const char *pos, uint32_t n_chars)
+    {
+        uint32_t n_scalar = n_chars;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        if(n_chars >= 8) n_scalar = n_chars - 8;
+#endif
+        digit_t v = 0;
+        for(uint32_t idx = 0; idx < n_scalar; ++idx)
+        {
+            digit_t d = digit_t(pos[idx]) - '0';
+            if(d > 9) throw std::invalid_argument("Not a number");
+            v = v * 10 + d;
+        }
+        if(n_scalar < n_chars)
+        {
+            digit_t low;
+            if(!parse_eight_decimals(pos + n_scalar, &low)) throw std::invalid_argument("Not a number");
+            v = v * powers_of_ten[8] + low;
+        }
+        return v;
+    }
+
+    // the value of up to chars_per_digit characters at pos, along with base^n_chars to scale by. throws if any of them isn't valid in the base
+    [[nodiscard]] static digit_t parse_chunk(const char *pos, uint32_t n_chars, const radix &r, digit_t *scale)
+    {
+        if(r.base == 10)
+        {
+            *scale = powers_of_ten[n_chars];
+            return parse_decimal_chunk(pos, n_chars);
+        }
+
+        digit_t v = 0;
+        *scale = 1;
+        for(uint32_t idx = 0; idx < n_chars; ++idx)
+        {
+            digit_t d = radix_char_value(pos[idx]);
+            if(d >= r.base) throw std::invalid_argument("Not a number");
+            v = v * r.base + d;
+            *scale *= r.base;
+        }
+        return v;
+    }
+
+    // parses a run of characters with no sign into the non-negative dest, a chunk at a time
+    [[nodiscard]] static numview parse_radix_basecase(numview dest, const char *pos, const char *end, const radix &r)
+    {
+        dest = zero_out(dest);
+        while(pos < end)
+        {
+            uint32_t n_chars = std::min<uint32_t>(end - pos, r.chars_per_digit);
+            digit_t scale;
+            digit_t chunk = parse_chunk(pos, n_chars, r, &scale);
+            pos += n_chars;
+            dest = abs_multiply_add_single_digit(dest, dest, scale, chunk);
+        }
+        return dest;
+    }
+
+    // below this many characters, multiplying in a chunk at a time beats combining halves
+    static constexpr uint32_t from_chars_combine_threshold = 700;
+
+    // divide and conquer: parse the low chunks*2^k characters and the rest separately, and combine them as high*chunk_modulus^(2^k) + low with the cached powers.
+    // with fast multiplication, this is subquadratic, where the base case alone is quadratic
+    [[nodiscard]] static numview parse_radix(numview dest, const char *pos, const char *end, const radix &r)
+    {
+        uint32_t n_chars = end - pos;
+        if(n_chars < from_chars_combine_threshold) return parse_radix_basecase(dest, pos, end, r);
+
+        // the low part gets between half and all but a few of the characters
+        uint32_t k = 0;
+        while((r.chars_per_digit << (k + 1)) < n_chars)
+        {
+            ++k;
+        }
+        uint32_t n_low_chars = r.chars_per_digit << k;
+        const char *split = end - n_low_chars;
+
+        MAKE_TEMPORARY_NUMVIEW(high, from_chars_digit_estimate(split - pos, r.base));
+        MAKE_TEMPORARY_NUMVIEW(low, from_chars_digit_estimate(n_low_chars, r.base));
+        high = parse_radix(high, pos, split, r);
+        low = parse_radix(low, split, end, r);
+
+        numview power = power_for_split(r, k);
+        uint32_t n_scaled_digits = multiply_digit_estimate(high.n_digits, power.n_digits);
+        MAKE_TEMPORARY_NUMVIEW(scaled, n_scaled_digits);
+        MAKE_TEMPORARY_NUMVIEW(combined, add_digit_estimate(n_scaled_digits, low.n_digits));
+        scaled = multiply(scaled, high, power);
+        combined = add(combined, scaled, low);
+        return copy_view(dest, combined);
+    }
+
+    // for bases that are powers of two, every character lands in a fixed group of bits, so this is linear time
+    [[nodiscard]] static numview parse_power_of_two(numview dest, const char *pos, const char *end, uint32_t base, uint32_t bits_per_char)
+    {
+        uint32_t n_chars = end - pos;
+        dest.n_digits = cdiv(n_chars * bits_per_char, n_bits_in_digit);
+        memset(dest.digits, 0, dest.n_digits * sizeof(digit_t));
+        for(uint32_t idx = 0; idx < n_chars; ++idx)
+        {
+            digit_t d = radix_char_value(end[-1 - int32_t(idx)]);
+            if(d >= base) throw std::invalid_argument("Not a number");
+
+            // a character can straddle two digits
+            uint32_t bit = idx * bits_per_char;
+            uint32_t digit_idx = bit / n_bits_in_digit;
+            uint32_t bit_in_digit = bit % n_bits_in_digit;
+            dest.digits[digit_idx] |= d << bit_in_digit;
+            if(bit_in_digit + bits_per_char > n_bits_in_digit) dest.digits[digit_idx + 1] |= d >> (n_bits_in_digit - bit_in_digit);
+        }
+        return with_sign_unless_zero(1, remove_high_zeros(dest));
+    }
+
+    // from_chars converts a numeric string in the given base to a numview.
+    [[nodiscard]] numview from_chars(numview dest, const char *pos, const char *end, uint32_t base)
     {
         signum_t sign = 1;
         if(pos == end)
@@ -90,35 +475,12 @@ namespace rqm
             }
         }
 
-        // now onto the main parsing
-
+        if(uint32_t bits_per_char = bits_per_radix_char(base); bits_per_char != 0)
         {
-            MAKE_STACK_TEMPORARY_NUMVIEW(single_digit, 1);
-            MAKE_STACK_TEMPORARY_NUMVIEW(tmp, from_chars_digit_estimate(end - pos));
-            bool first = true;
-            while(pos < end)
-            {
-                uint32_t n_digits = std::min<uint32_t>(end - pos, n_decimals_in_digit_low);
-                auto [ptr, ec] = std::from_chars(pos, pos + n_digits, single_digit_storage[0]);
-                if(ec != std::errc() || ptr != pos + n_digits)
-                {
-                    throw std::invalid_argument("Not a number");
-                }
-                pos = ptr;
-
-                single_digit.n_digits = single_digit.signum = single_digit_storage[0] != 0;
-
-                if(first)
-                {
-                    dest = copy_view(dest, single_digit);
-                    first = false;
-                } else
-                {
-                    digit_t scale = digit_t(std::pow(10.0, n_digits));
-                    tmp = multiply_with_single_digit(tmp, dest, scale);
-                    dest = add(dest, tmp, single_digit);
-                }
-            }
+            dest = parse_power_of_two(dest, pos, end, base, bits_per_char);
+        } else
+        {
+            dest = parse_radix(dest, pos, end, base == 10 ? decimal_radix : radix(base));
         }
         return with_sign_unless_zero(sign, dest);
     }
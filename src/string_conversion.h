@@ -6,28 +6,65 @@
 #include <cassert>
 #include <charconv>
 #include <cstdint>
+#include <iosfwd>
+#include <stdexcept>
 #include <string_view>
 
 namespace rqm
 {
 
-    [[nodiscard]] static inline constexpr uint32_t to_string_buffer_estimate(uint32_t n_digits)
+    // bases 2 to 36 are supported, with the letters a to z for the values 10 to 35
+    static inline void check_base(uint32_t base)
     {
-        // 1 for possible sign, maximum number of decimals per digits times number of digits, and one for the terminating zero in the fast path
-        return 1 + 1 + n_decimals_in_digit_high * n_digits;
+        if(base < 2 || base > 36) throw std::invalid_argument("Unsupported base");
     }
 
-    [[nodiscard]] std::string_view to_string(char *end, const numview n);
+    // the most characters in the given base that always fit in a digit, so that base^n <= 2^32
+    [[nodiscard]] static inline constexpr uint32_t n_chars_in_digit_low(uint32_t base)
+    {
+        if(base == 10) return n_decimals_in_digit_low; // skip the loop for the common case
+        uint32_t n = 0;
+        for(uint64_t v = base; v <= (uint64_t(1) << n_bits_in_digit); v *= base)
+        {
+            ++n;
+        }
+        return n;
+    }
+
+    // the fewest characters in the given base that can hold any digit, so that base^n >= 2^32
+    [[nodiscard]] static inline constexpr uint32_t n_chars_in_digit_high(uint32_t base)
+    {
+        if(base == 10) return n_decimals_in_digit_high; // skip the loop for the common case
+        uint32_t n = 0;
+        for(uint64_t v = 1; v < (uint64_t(1) << n_bits_in_digit); v *= base)
+        {
+            ++n;
+        }
+        return n;
+    }
+
+    [[nodiscard]] static inline constexpr uint32_t to_string_buffer_estimate(uint32_t n_digits, uint32_t base = 10)
+    {
+        // 1 for possible sign, maximum number of characters per digits times number of digits, and one to spare
+        return 1 + 1 + n_chars_in_digit_high(base) * n_digits;
+    }
+
+    [[nodiscard]] std::string_view to_string(char *end, const numview n, uint32_t base = 10);
+
+    // writes n in decimal to os as the characters are produced, a fixed-size buffer at a time, so the text never has to be held in full
+    void write_decimal(std::ostream &os, const numview n);
+
+    // 10^(9*2^k), from the per-thread cache that to_string and from_chars split by
+    [[nodiscard]] numview decimal_split_power(uint32_t k);
 
-    [[nodiscard]] static inline constexpr uint32_t from_chars_digit_estimate(uint32_t n_chars)
+    [[nodiscard]] static inline constexpr uint32_t from_chars_digit_estimate(uint32_t n_chars, uint32_t base = 10)
     {
-        // at least one digit, plus one for each time we have a new batch of n_decimals_in_digit_low decimals
-        return 1 + n_chars / n_decimals_in_digit_low;
+        // at least one digit, plus one for each time we have a new batch of characters that fills a digit
+        return 1 + n_chars / n_chars_in_digit_low(base);
     }
 
-    // from_chars converts a numeric string in base-10 to a numview.
-    // we take two buffers, dest1 and dest2, and may use either of them for the destination
-    [[nodiscard]] numview from_chars(numview dest, const char *pos, const char *end);
+    // from_chars converts a numeric string in the given base to a numview.
+    [[nodiscard]] numview from_chars(numview dest, const char *pos, const char *end, uint32_t base = 10);
 } // namespace rqm
 
 #endif // RQM_STRING_CONVERSION_H
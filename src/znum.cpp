@@ -1,4 +1,5 @@
 #include "rqm/znum.h"
+#include "rqm/znum_view.h"
 #include <cstdint>
 #include <cstring>
 #include <istream>
@@ -6,6 +7,7 @@
 #include <ostream>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 #include "basic_arithmetic.h"
 #include "numview.h"
@@ -14,20 +16,14 @@
 namespace rqm
 {
 
-    znum::znum(int64_t value)
+    znum znum::from_digits(signum_t signum, const digit_t *digits, uint32_t n_digits)
     {
-        _signum = compare_signum(value, int64_t(0));
-        int64_t abs_value = std::abs(value);
-        is_stored_inline = true;
-        u.digits_inline[0] = abs_value & 0xffffffff;
-        u.digits_inline[1] = abs_value >> 32;
-        uint32_t digs = 2;
-        if(u.digits_inline[1] == 0)
-        {
-            digs = 1;
-            if(u.digits_inline[0] == 0) digs = 0;
-        }
-        _n_digits = digs;
+        assert(n_digits == 0 || digits[n_digits - 1] != 0);
+        znum v(empty_with_n_digits(), n_digits);
+        // zero may come with no digits at all, and memcpy doesn't take a null pointer even for no bytes
+        if(n_digits != 0) std::memcpy(v.mutable_digits(), digits, n_digits * sizeof(digit_t));
+        v._signum = n_digits == 0 ? 0 : signum;
+        return v;
     }
 
     int64_t znum::to_int64_t() const
@@ -44,6 +40,45 @@ namespace rqm
         return v * _signum;
     }
 
+    void znum::reserve(uint32_t n_digits)
+    {
+        if(n_digits <= capacity()) return;
+
+        uint8_t new_capacity_log2 = capacity_log2_for(n_digits);
+        digit_t *ptr = allocate_digits(new_capacity_log2);
+        std::memcpy(ptr, digits(), _n_digits * sizeof(digit_t));
+        if(!stored_inline())
+        {
+            deallocate_digits(u.digits_ptr, heap_capacity_log2);
+        }
+        is_stored_inline = false;
+        heap_capacity_log2 = new_capacity_log2;
+        u.digits_ptr = ptr;
+    }
+
+    void znum::shrink_to_fit()
+    {
+        if(stored_inline()) return;
+
+        if(_n_digits <= n_inline_digits)
+        {
+            digit_t *ptr = u.digits_ptr;
+            std::memcpy(u.digits_inline, ptr, _n_digits * sizeof(digit_t));
+            deallocate_digits(ptr, heap_capacity_log2);
+            is_stored_inline = true;
+            return;
+        }
+
+        uint8_t new_capacity_log2 = capacity_log2_for(_n_digits);
+        if(new_capacity_log2 == heap_capacity_log2) return;
+
+        digit_t *ptr = allocate_digits(new_capacity_log2);
+        std::memcpy(ptr, u.digits_ptr, _n_digits * sizeof(digit_t));
+        deallocate_digits(u.digits_ptr, heap_capacity_log2);
+        heap_capacity_log2 = new_capacity_log2;
+        u.digits_ptr = ptr;
+    }
+
     znum::znum(numview o)
         : _signum(o.signum)
     {
@@ -58,6 +93,16 @@ namespace rqm
         assert(digits() == o.digits);
     }
 
+    void znum::assign(numview o)
+    {
+        if(o.n_digits > capacity())
+        {
+            *this = znum(o);
+            return;
+        }
+        update_signum_n_digits(copy_view(numview(mutable_digits()), o));
+    }
+
     uint32_t znum::n_bits() const
     {
         return rqm::n_bits(to_numview());
@@ -108,21 +153,21 @@ namespace rqm
         return znum(negate(a.to_numview()));
     }
 
-    znum operator+(const znum &a, const znum &b)
+    znum add_general(const znum &a, const znum &b)
     {
         znum c(znum::empty_with_n_digits(), add_digit_estimate(a.n_digits(), b.n_digits()));
         c.update_signum_n_digits(add(c.to_numview(), a.to_numview(), b.to_numview()));
         return c;
     }
 
-    znum operator-(const znum &a, const znum &b)
+    znum subtract_general(const znum &a, const znum &b)
     {
         znum c(znum::empty_with_n_digits(), add_digit_estimate(a.n_digits(), b.n_digits()));
         c.update_signum_n_digits(add(c.to_numview(), a.to_numview(), negate(b.to_numview())));
         return c;
     }
 
-    znum operator*(const znum &a, const znum &b)
+    znum multiply_general(const znum &a, const znum &b)
     {
         znum c(znum::empty_with_n_digits(), multiply_digit_estimate(a.n_digits(), b.n_digits()));
         c.update_signum_n_digits(multiply(c.to_numview(), a.to_numview(), b.to_numview()));
@@ -177,7 +222,7 @@ namespace rqm
         {
             bu = -b;
         }
-        MAKE_STACK_TEMPORARY_NUMVIEW(quotient, quotient_digit_estimate(a.n_digits(), 1));
+        MAKE_TEMPORARY_NUMVIEW(quotient, quotient_digit_estimate(a.n_digits(), 1));
         int64_t modulo = 0;
         quotient = divmod_by_single_digit(quotient, &modulo, a.to_numview(), bu);
         return modulo;
@@ -192,7 +237,7 @@ namespace rqm
 
     znum operator%(const znum &a, const znum &b)
     {
-        MAKE_STACK_TEMPORARY_NUMVIEW(quotient, quotient_digit_estimate(a.n_digits(), b.n_digits()));
+        MAKE_TEMPORARY_NUMVIEW(quotient, quotient_digit_estimate(a.n_digits(), b.n_digits()));
         znum c(znum::empty_with_n_digits(), modulo_digit_estimate(a.n_digits(), b.n_digits()));
 
         numview modulo = c.to_numview();
@@ -201,6 +246,120 @@ namespace rqm
         return c;
     }
 
+    std::pair<znum, znum> divmod(const znum &a, const znum &b)
+    {
+        znum q(znum::empty_with_n_digits(), quotient_digit_estimate(a.n_digits(), b.n_digits()));
+        znum r(znum::empty_with_n_digits(), modulo_digit_estimate(a.n_digits(), b.n_digits()));
+
+        numview remainder = r.to_numview();
+        q.update_signum_n_digits(divmod(q.to_numview(), &remainder, a.to_numview(), b.to_numview()));
+        r.update_signum_n_digits(remainder);
+        return {std::move(q), std::move(r)};
+    }
+
+    std::pair<znum, int32_t> divmod(const znum &a, int32_t b)
+    {
+        znum q;
+        int32_t r = 0;
+        tdiv_qr(q, r, a, b);
+        return {std::move(q), r};
+    }
+
+    enum class rounding
+    {
+        truncate,
+        floor,
+        ceil
+    };
+
+    // divides, then nudges the truncated quotient and remainder over to the requested rounding. the quotient needs room for a digit more than
+    // quotient_digit_estimate, and the remainder for add_digit_estimate(modulo_digit_estimate, divisor)
+    static void divmod_rounding(numview &quotient, numview &remainder, const numview dividend, const numview divisor, rounding mode)
+    {
+        if(divisor.n_digits == 1)
+        {
+            int64_t modulo = 0;
+            quotient = divmod_by_single_digit(quotient, &modulo, dividend, divisor.digits[0]);
+            if(divisor.signum < 0)
+            {
+                quotient = rqm::negate(quotient);
+            }
+            remainder.digits[0] = std::abs(modulo);
+            remainder.n_digits = modulo != 0;
+            remainder.signum = compare_signum(modulo, int64_t(0));
+        } else
+        {
+            quotient = divmod(quotient, &remainder, dividend, divisor);
+        }
+
+        // the truncated remainder has the sign of the dividend. floor wants it to follow the divisor, ceiling wants the opposite
+        if(remainder.signum == 0 || mode == rounding::truncate) return;
+        static const digit_t one_digit = 1;
+        if(mode == rounding::floor && remainder.signum != divisor.signum)
+        {
+            quotient = add(quotient, quotient, numview(1, -1, &one_digit));
+            remainder = add(remainder, remainder, divisor);
+        } else if(mode == rounding::ceil && remainder.signum == divisor.signum)
+        {
+            quotient = add(quotient, quotient, numview(1, 1, &one_digit));
+            remainder = add(remainder, remainder, rqm::negate(divisor));
+        }
+    }
+
+    static void divmod_rounding(znum &q, znum &r, const znum &a, const znum &b, rounding mode)
+    {
+        assert(&q != &r);
+        // q and r may be a or b, so everything is worked out in temporaries before either is written
+        MAKE_TEMPORARY_NUMVIEW(quotient, quotient_digit_estimate(a.n_digits(), b.n_digits()) + 1);
+        MAKE_TEMPORARY_NUMVIEW(remainder, add_digit_estimate(modulo_digit_estimate(a.n_digits(), b.n_digits()), b.n_digits()));
+        divmod_rounding(quotient, remainder, a.to_numview(), b.to_numview(), mode);
+        q.assign(quotient);
+        r.assign(remainder);
+    }
+
+    static void divmod_rounding(znum &q, int32_t &r, const znum &a, int32_t b, rounding mode)
+    {
+        digit_t b_digit = b < 0 ? -uint32_t(b) : uint32_t(b);
+        numview divisor(b != 0, compare_signum(b, int32_t(0)), &b_digit);
+        MAKE_TEMPORARY_NUMVIEW(quotient, quotient_digit_estimate(a.n_digits(), 1) + 1);
+        digit_t remainder_digits[2];
+        numview remainder(remainder_digits);
+        divmod_rounding(quotient, remainder, a.to_numview(), divisor, mode);
+        // |remainder| < |b|, so it always fits
+        r = int32_t(int64_t(remainder.n_digits != 0 ? remainder.digits[0] : 0) * remainder.signum);
+        q.assign(quotient);
+    }
+
+    void tdiv_qr(znum &q, znum &r, const znum &a, const znum &b)
+    {
+        divmod_rounding(q, r, a, b, rounding::truncate);
+    }
+
+    void fdiv_qr(znum &q, znum &r, const znum &a, const znum &b)
+    {
+        divmod_rounding(q, r, a, b, rounding::floor);
+    }
+
+    void cdiv_qr(znum &q, znum &r, const znum &a, const znum &b)
+    {
+        divmod_rounding(q, r, a, b, rounding::ceil);
+    }
+
+    void tdiv_qr(znum &q, int32_t &r, const znum &a, int32_t b)
+    {
+        divmod_rounding(q, r, a, b, rounding::truncate);
+    }
+
+    void fdiv_qr(znum &q, int32_t &r, const znum &a, int32_t b)
+    {
+        divmod_rounding(q, r, a, b, rounding::floor);
+    }
+
+    void cdiv_qr(znum &q, int32_t &r, const znum &a, int32_t b)
+    {
+        divmod_rounding(q, r, a, b, rounding::ceil);
+    }
+
     znum operator*(int32_t a, const znum &b)
     {
         return b * a;
@@ -220,27 +379,392 @@ namespace rqm
         return c;
     }
 
+    znum &znum::operator+=(const znum &o)
+    {
+        if(stored_inline() && fits_in_double_digit() && o.fits_in_double_digit()) return *this = *this + o;
+        if(add_digit_estimate(_n_digits, o._n_digits) > capacity()) return *this = add_general(*this, o);
+
+        update_signum_n_digits(add(numview(mutable_digits()), to_numview(), o.to_numview()));
+        return *this;
+    }
+
+    znum &znum::operator-=(const znum &o)
+    {
+        if(stored_inline() && fits_in_double_digit() && o.fits_in_double_digit()) return *this = *this - o;
+        if(add_digit_estimate(_n_digits, o._n_digits) > capacity()) return *this = subtract_general(*this, o);
+
+        update_signum_n_digits(add(numview(mutable_digits()), to_numview(), rqm::negate(o.to_numview())));
+        return *this;
+    }
+
+    znum &znum::operator*=(const znum &o)
+    {
+        uint32_t estimate = multiply_digit_estimate(_n_digits, o._n_digits);
+        if(estimate > capacity()) return *this = multiply_general(*this, o);
+
+        // multiplying by a single digit can write over its input
+        if(o._n_digits == 1)
+        {
+            numview res = multiply_with_single_digit(numview(mutable_digits()), to_numview(), o.digits()[0]);
+            update_signum_n_digits(with_signum(_signum * o._signum, res));
+            return *this;
+        }
+        if(stored_inline() && fits_in_double_digit() && o.fits_in_double_digit()) return *this = *this * o;
+
+        // the general multiplication can't, so go through a temporary and copy back into our own storage
+        MAKE_TEMPORARY_NUMVIEW(product, estimate);
+        product = multiply(product, to_numview(), o.to_numview());
+        update_signum_n_digits(copy_view(numview(mutable_digits()), product));
+        return *this;
+    }
+
+    void znum::multiply_accumulate(numview a, numview b)
+    {
+        if(a.digits == digits() || b.digits == digits())
+        {
+            // accumulating into one of the operands. the kernel would read digits it has already overwritten, so form the product on the side
+            MAKE_TEMPORARY_NUMVIEW(product, multiply_digit_estimate(a.n_digits, b.n_digits));
+            product = multiply(product, a, b);
+            reserve(add_digit_estimate(_n_digits, product.n_digits));
+            update_signum_n_digits(add(numview(mutable_digits()), to_numview(), product));
+            return;
+        }
+
+        reserve(addmul_digit_estimate(_n_digits, a.n_digits, b.n_digits));
+        update_signum_n_digits(addmul(numview(_n_digits, _signum, mutable_digits()), a, b));
+    }
+
+    void addmul(znum &acc, const znum &a, const znum &b)
+    {
+        acc.multiply_accumulate(a.to_numview(), b.to_numview());
+    }
+
+    void submul(znum &acc, const znum &a, const znum &b)
+    {
+        acc.multiply_accumulate(rqm::negate(a.to_numview()), b.to_numview());
+    }
+
+    void addmul_ui(znum &acc, const znum &a, uint64_t b)
+    {
+        digit_t b_digits[2] = {digit_t(b), digit_t(b >> n_bits_in_digit)};
+        numview b_view(b_digits[1] != 0 ? 2 : b_digits[0] != 0 ? 1 : 0, b != 0, b_digits);
+        acc.multiply_accumulate(a.to_numview(), b_view);
+    }
+
+    void submul_ui(znum &acc, const znum &a, uint64_t b)
+    {
+        digit_t b_digits[2] = {digit_t(b), digit_t(b >> n_bits_in_digit)};
+        numview b_view(b_digits[1] != 0 ? 2 : b_digits[0] != 0 ? 1 : 0, b != 0, b_digits);
+        acc.multiply_accumulate(rqm::negate(a.to_numview()), b_view);
+    }
+
+    znum &znum::operator*=(int32_t o)
+    {
+        if(multiply_digit_estimate(_n_digits, 1) > capacity()) return *this = *this * o;
+
+        uint32_t ou = o < 0 ? -uint32_t(o) : o;
+        numview res = multiply_with_single_digit(numview(mutable_digits()), to_numview(), ou);
+        if(o < 0)
+        {
+            res = rqm::negate(res);
+        }
+        update_signum_n_digits(res);
+        return *this;
+    }
+
+    znum &znum::operator/=(const znum &o)
+    {
+        // the quotient is never longer than the dividend, so it always fits
+        update_signum_n_digits(divmod(numview(mutable_digits()), nullptr, to_numview(), o.to_numview()));
+        return *this;
+    }
+
+    znum &znum::operator/=(int32_t o)
+    {
+        uint32_t ou = o < 0 ? -uint32_t(o) : o;
+        numview res = divmod_by_single_digit(numview(mutable_digits()), nullptr, to_numview(), ou);
+        if(o < 0)
+        {
+            res = rqm::negate(res);
+        }
+        update_signum_n_digits(res);
+        return *this;
+    }
+
+    znum &znum::operator%=(const znum &o)
+    {
+        // the remainder is never longer than the dividend, so it always fits
+        MAKE_TEMPORARY_NUMVIEW(quotient, quotient_digit_estimate(_n_digits, o._n_digits));
+        numview modulo(mutable_digits());
+        quotient = divmod(quotient, &modulo, to_numview(), o.to_numview());
+        update_signum_n_digits(modulo);
+        return *this;
+    }
+
+    znum &znum::operator%=(int32_t o)
+    {
+        return *this = *this % o;
+    }
+
+    znum &znum::operator<<=(uint32_t o)
+    {
+        if(shift_left_digit_estimate(_n_digits, o) > capacity()) return *this = *this << o;
+
+        update_signum_n_digits(shift_left(numview(mutable_digits()), to_numview(), o));
+        return *this;
+    }
+
+    znum &znum::operator>>=(uint32_t o)
+    {
+        if(shift_right_digit_estimate(_n_digits, o) > capacity()) return *this = *this >> o;
+
+        update_signum_n_digits(shift_right(numview(mutable_digits()), to_numview(), o));
+        return *this;
+    }
+
+    znum bitwise_and_general(const znum &a, const znum &b)
+    {
+        znum c(znum::empty_with_n_digits(), bitwise_digit_estimate(a.n_digits(), b.n_digits()));
+        c.update_signum_n_digits(bitwise_and(c.to_numview(), a.to_numview(), b.to_numview()));
+        return c;
+    }
+
+    znum bitwise_or_general(const znum &a, const znum &b)
+    {
+        znum c(znum::empty_with_n_digits(), bitwise_digit_estimate(a.n_digits(), b.n_digits()));
+        c.update_signum_n_digits(bitwise_or(c.to_numview(), a.to_numview(), b.to_numview()));
+        return c;
+    }
+
+    znum bitwise_xor_general(const znum &a, const znum &b)
+    {
+        znum c(znum::empty_with_n_digits(), bitwise_digit_estimate(a.n_digits(), b.n_digits()));
+        c.update_signum_n_digits(bitwise_xor(c.to_numview(), a.to_numview(), b.to_numview()));
+        return c;
+    }
+
+    znum &znum::operator&=(const znum &o)
+    {
+        if(bitwise_digit_estimate(_n_digits, o._n_digits) > capacity()) return *this = bitwise_and_general(*this, o);
+
+        update_signum_n_digits(bitwise_and(numview(mutable_digits()), to_numview(), o.to_numview()));
+        return *this;
+    }
+
+    znum &znum::operator|=(const znum &o)
+    {
+        if(bitwise_digit_estimate(_n_digits, o._n_digits) > capacity()) return *this = bitwise_or_general(*this, o);
+
+        update_signum_n_digits(bitwise_or(numview(mutable_digits()), to_numview(), o.to_numview()));
+        return *this;
+    }
+
+    znum &znum::operator^=(const znum &o)
+    {
+        if(bitwise_digit_estimate(_n_digits, o._n_digits) > capacity()) return *this = bitwise_xor_general(*this, o);
+
+        update_signum_n_digits(bitwise_xor(numview(mutable_digits()), to_numview(), o.to_numview()));
+        return *this;
+    }
+
+    znum &znum::set_bit(uint32_t bit)
+    {
+        if(test_bit(*this, bit)) return *this;
+        if(_signum < 0) return *this += znum(1) << bit; // a clear bit of a negative number is worth 2^bit
+
+        // a non-negative number just gets the bit, growing to reach it if need be
+        uint32_t idx = bit / n_bits_in_digit;
+        if(idx >= _n_digits)
+        {
+            reserve(idx + 1);
+            std::memset(mutable_digits() + _n_digits, 0, (idx + 1 - _n_digits) * sizeof(digit_t));
+            _n_digits = idx + 1;
+        }
+        mutable_digits()[idx] |= digit_t(1) << (bit % n_bits_in_digit);
+        _signum = 1;
+        return *this;
+    }
+
+    znum &znum::clear_bit(uint32_t bit)
+    {
+        if(!test_bit(*this, bit)) return *this;
+        if(_signum < 0) return *this -= znum(1) << bit;
+
+        mutable_digits()[bit / n_bits_in_digit] &= ~(digit_t(1) << (bit % n_bits_in_digit));
+        update_signum_n_digits(with_sign_unless_zero(1, remove_high_zeros(to_numview())));
+        return *this;
+    }
+
+    bool test_bit(const znum &a, uint32_t bit)
+    {
+        return test_bit(a.to_numview(), bit);
+    }
+
+    uint64_t popcount(const znum &a)
+    {
+        return popcount(a.to_numview());
+    }
+
+    uint64_t hamming_distance(const znum &a, const znum &b)
+    {
+        return hamming_distance(a.to_numview(), b.to_numview());
+    }
+
+    // above this many digits, operator<< streams the characters out instead of formatting them all first
+    static constexpr uint32_t stream_output_threshold = 1024;
+
     std::ostream &operator<<(std::ostream &os, const znum &a)
     {
+        if(a.n_digits() >= stream_output_threshold && os.width() == 0)
+        {
+            std::ostream::sentry sentry(os);
+            if(sentry) write_decimal(os, a.to_numview());
+            return os;
+        }
         uint32_t buf_size = to_string_buffer_estimate(a.n_digits());
-        char buf[buf_size];
+        scratch_space<char> buf(buf_size);
         std::string_view sv = to_string(&buf[buf_size], a.to_numview());
         return (os << sv);
     }
 
-    std::string to_string(const znum &a)
+    // operator>> reads this many characters at a time. it is 9*2^stream_block_level, so that blocks combine with the cached powers of ten
+    static constexpr uint32_t stream_block_level = 8;
+    static constexpr uint32_t stream_block_size = n_decimals_in_digit_low << stream_block_level;
+
+    // assembles a number from blocks of decimal characters, most significant first.
+    // equal-sized neighbours are merged as they arrive, like carries in a binary counter, so the merges are balanced and subquadratic
+    class decimal_block_accumulator
     {
-        uint32_t buf_size = to_string_buffer_estimate(a.n_digits());
-        char buf[buf_size];
-        std::string_view sv = to_string(&buf[buf_size], a.to_numview());
+    public:
+        void push_block(const char *pos)
+        {
+            znum value = znum::from_string(std::string_view(pos, stream_block_size));
+            uint32_t level = 0;
+            while(!blocks.empty() && blocks.back().second == level)
+            {
+                value = blocks.back().first * block_power(level) + value;
+                blocks.pop_back();
+                ++level;
+            }
+            blocks.emplace_back(std::move(value), level);
+        }
+
+        // the last n_chars characters, fewer than a full block, and the value of everything
+        znum finish(const char *pos, uint32_t n_chars)
+        {
+            znum acc = n_chars == 0 ? znum() : znum::from_string(std::string_view(pos, n_chars));
+            znum scale = 1;
+            for(uint32_t idx = 0; idx < n_chars / n_decimals_in_digit_low; ++idx)
+            {
+                scale *= 1000000000;
+            }
+            for(uint32_t idx = 0; idx < n_chars % n_decimals_in_digit_low; ++idx)
+            {
+                scale *= 10;
+            }
+
+            while(!blocks.empty())
+            {
+                acc = blocks.back().first * scale + acc;
+                if(blocks.size() > 1) scale = scale * block_power(blocks.back().second);
+                blocks.pop_back();
+            }
+            return acc;
+        }
+
+    private:
+        // 10 to the number of characters in a block of this level
+        static znum_view block_power(uint32_t level)
+        {
+            numview p = decimal_split_power(stream_block_level + level);
+            return znum_view(p.signum, p.digits, p.n_digits);
+        }
+
+        std::vector<std::pair<znum, uint32_t>> blocks;
+    };
+
+    std::istream &operator>>(std::istream &is, znum &a)
+    {
+        std::istream::sentry sentry(is);
+        if(!sentry) return is;
+
+        std::streambuf *sb = is.rdbuf();
+        std::ios_base::iostate state = std::ios_base::goodbit;
+        signum_t sign = 1;
+        if(sb->sgetc() == '-')
+        {
+            sign = -1;
+            sb->sbumpc();
+        }
+
+        decimal_block_accumulator acc;
+        char buf[stream_block_size];
+        uint32_t n_buffered = 0;
+        bool any_digits = false;
+        while(true)
+        {
+            int c = sb->sgetc();
+            if(c == std::char_traits<char>::eof())
+            {
+                state |= std::ios_base::eofbit;
+                break;
+            }
+            if(c < '0' || c > '9') break;
+            sb->sbumpc();
+            any_digits = true;
+            buf[n_buffered++] = char(c);
+            if(n_buffered == stream_block_size)
+            {
+                acc.push_block(buf);
+                n_buffered = 0;
+            }
+        }
+
+        if(any_digits)
+        {
+            znum value = acc.finish(buf, n_buffered);
+            a = sign < 0 ? -value : std::move(value);
+        } else
+        {
+            state |= std::ios_base::failbit;
+        }
+        is.setstate(state);
+        return is;
+    }
+
+    std::string to_string(const znum &a, uint32_t base)
+    {
+        check_base(base);
+        uint32_t buf_size = to_string_buffer_estimate(a.n_digits(), base);
+        scratch_space<char> buf(buf_size);
+        std::string_view sv = to_string(&buf[buf_size], a.to_numview(), base);
         return std::string(sv);
     }
 
-    znum znum::from_string(const std::string_view sv)
+    uint32_t to_chars_max_size(const znum &a, uint32_t base)
     {
-        znum c(znum::empty_with_n_digits(), from_chars_digit_estimate(sv.size()));
+        check_base(base);
+        return to_string_buffer_estimate(a.n_digits(), base);
+    }
+
+    std::to_chars_result to_chars(char *first, char *last, const znum &a, uint32_t base)
+    {
+        // the digits come out from the least significant end, so format into scratch space and copy to the front of the caller's buffer
+        check_base(base);
+        uint32_t buf_size = to_string_buffer_estimate(a.n_digits(), base);
+        scratch_space<char> buf(buf_size);
+        std::string_view sv = to_string(&buf[buf_size], a.to_numview(), base);
+        if(sv.size() > size_t(last - first)) return {last, std::errc::value_too_large};
+        memcpy(first, sv.data(), sv.size());
+        return {first + sv.size(), std::errc()};
+    }
 
-        c.update_signum_n_digits(from_chars(c.to_numview(), sv.cbegin(), sv.cend()));
+    znum znum::from_string(const std::string_view sv, uint32_t base)
+    {
+        check_base(base);
+        znum c(znum::empty_with_n_digits(), from_chars_digit_estimate(sv.size(), base));
+
+        c.update_signum_n_digits(from_chars(c.to_numview(), sv.cbegin(), sv.cend(), base));
         return c;
     }
 
@@ -249,6 +773,52 @@ namespace rqm
         return countr_zero(v.to_numview());
     }
 
+    znum pow(const znum &a, uint64_t exp)
+    {
+        if(exp == 0) return znum::one();
+        if(a.signum() == 0 || exp == 1) return a;
+        signum_t signum = a.signum() < 0 && (exp & 1) != 0 ? -1 : 1;
+
+        // with a = odd*2^n_twos, the power of two becomes a shift at the end, and only odd needs squaring
+        numview magnitude = abs(a.to_numview());
+        uint32_t n_twos = countr_zero(magnitude);
+        MAKE_TEMPORARY_NUMVIEW(odd, a.n_digits());
+        odd = shift_right(odd, magnitude, n_twos);
+
+        if(n_twos != 0 && exp > UINT32_MAX / n_twos) throw std::overflow_error("Result of pow too large");
+        uint64_t n_shift_bits = uint64_t(n_twos) * exp;
+        if(odd.n_digits == 1 && odd.digits[0] == 1) return znum(signum) << uint32_t(n_shift_bits);
+
+        // odd^exp < 2^(n_bits(odd)*exp), so this is enough room for every intermediate and the shifted result
+        uint64_t max_result_bits = uint64_t(UINT32_MAX - 1) * n_bits_in_digit;
+        uint32_t n_odd_bits = n_bits(odd);
+        if(exp > max_result_bits / n_odd_bits) throw std::overflow_error("Result of pow too large");
+        uint64_t n_result_bits = n_odd_bits * exp + n_shift_bits;
+        if(n_result_bits > max_result_bits) throw std::overflow_error("Result of pow too large");
+        uint32_t n_result_digits = cdiv<uint64_t>(n_result_bits, n_bits_in_digit) + 1;
+
+        // ping-pong between the result and a scratch buffer of the same size, so nothing is reallocated along the way
+        znum c(znum::empty_with_n_digits(), n_result_digits);
+        MAKE_TEMPORARY_NUMVIEW(other, n_result_digits);
+        numview x = copy_view(c.to_numview(), odd);
+        numview y = other;
+        for(int32_t bit = 62 - __builtin_clzll(exp); bit >= 0; --bit)
+        {
+            y = multiply(numview(y.digits), x, x);
+            std::swap(x, y);
+            if((exp >> bit) & 1)
+            {
+                y = multiply(numview(y.digits), x, odd);
+                std::swap(x, y);
+            }
+        }
+        if(x.digits == other.digits) x = copy_view(c.to_numview(), x);
+
+        c.update_signum_n_digits(with_signum(signum, x));
+        if(n_shift_bits != 0) c <<= uint32_t(n_shift_bits);
+        return c;
+    }
+
     znum gcd(const znum &a, const znum &b)
     {
         znum c(znum::empty_with_n_digits(), gcd_digit_estimate(a.n_digits(), b.n_digits()));
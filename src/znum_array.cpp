@@ -0,0 +1,225 @@
+#include "rqm/znum_array.h"
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(_WIN32)
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "numview.h"
+
+namespace rqm
+{
+    static constexpr char znum_array_magic[7] = {'r', 'q', 'm', 'Z', 'a', 'r', 'r'};
+    static constexpr uint8_t znum_array_version = 0;
+    static constexpr size_t znum_array_header_size = 16;
+
+    [[nodiscard]] static constexpr bool is_little_endian()
+    {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        return true;
+#elif defined(_WIN32)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    [[noreturn]] static void malformed_znum_array()
+    {
+        throw std::invalid_argument("Malformed znum array");
+    }
+
+    znum_array_view::znum_array_view(const std::byte *data, size_t size)
+    {
+        // the views hand out the digits in place, so they must be in host order
+        if(!is_little_endian()) throw std::runtime_error("znum arrays are only supported on little-endian hosts");
+        if(reinterpret_cast<uintptr_t>(data) % alignof(uint64_t) != 0) throw std::invalid_argument("znum array data is not 8-byte aligned");
+        if(size < znum_array_header_size || memcmp(data, znum_array_magic, sizeof(znum_array_magic)) != 0) malformed_znum_array();
+        if(uint8_t(data[7]) != znum_array_version) throw std::invalid_argument("Unsupported znum array version");
+
+        uint64_t count;
+        memcpy(&count, data + 8, sizeof(count));
+        size_t index_room = (size - znum_array_header_size) / sizeof(uint64_t);
+        if(count >= index_room) malformed_znum_array();
+
+        n_elements = size_t(count);
+        index = reinterpret_cast<const uint64_t *>(data + znum_array_header_size);
+        size_t pool_start = znum_array_header_size + (n_elements + 1) * sizeof(uint64_t);
+        pool = reinterpret_cast<const digit_t *>(data + pool_start);
+        n_pool_digits = (size - pool_start) / sizeof(digit_t);
+
+        // the ends of the pool have to add up, the elements in between are checked as they are read
+        if((index[0] >> 2) != 0 || (index[n_elements] >> 2) > n_pool_digits) malformed_znum_array();
+    }
+
+    znum_view znum_array_view::operator[](size_t idx) const
+    {
+        if(idx >= n_elements) throw std::out_of_range("znum array index out of range");
+        uint64_t begin = index[idx] >> 2;
+        uint64_t end = index[idx + 1] >> 2;
+        uint64_t sign_code = index[idx] & 3;
+        if(begin > end || end > n_pool_digits || end - begin > UINT32_MAX || sign_code > 1) malformed_znum_array();
+
+        uint32_t n_digits = uint32_t(end - begin);
+        if(n_digits == 0)
+        {
+            if(sign_code != 0) malformed_znum_array();
+            return znum_view();
+        }
+        const digit_t *digits = pool + begin;
+        if(digits[n_digits - 1] == 0) malformed_znum_array();
+        return znum_view(sign_code ? -1 : 1, digits, n_digits);
+    }
+
+    mapped_znum_array::mapped_znum_array(const std::string &path)
+    {
+#if defined(_WIN32)
+        // no mmap here, so read it into an aligned buffer instead
+        std::ifstream is(path, std::ios::binary | std::ios::ate);
+        if(!is) throw std::system_error(std::make_error_code(std::errc::no_such_file_or_directory), path);
+        mapping_size = size_t(is.tellg());
+        uint64_t *buf = new uint64_t[(mapping_size + sizeof(uint64_t) - 1) / sizeof(uint64_t)];
+        mapping = buf;
+        is.seekg(0);
+        if(!is.read(reinterpret_cast<char *>(buf), std::streamsize(mapping_size)))
+        {
+            release();
+            throw std::system_error(std::make_error_code(std::errc::io_error), path);
+        }
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if(fd < 0) throw std::system_error(errno, std::generic_category(), path);
+        struct stat st;
+        if(fstat(fd, &st) != 0)
+        {
+            int err = errno;
+            close(fd);
+            throw std::system_error(err, std::generic_category(), path);
+        }
+        mapping_size = size_t(st.st_size);
+        if(mapping_size != 0)
+        {
+            void *p = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if(p == MAP_FAILED)
+            {
+                int err = errno;
+                close(fd);
+                throw std::system_error(err, std::generic_category(), path);
+            }
+            mapping = p;
+        }
+        // the mapping stays valid without the descriptor
+        close(fd);
+#endif
+        try
+        {
+            array = znum_array_view(static_cast<const std::byte *>(mapping), mapping_size);
+        }
+        catch(...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    mapped_znum_array::~mapped_znum_array()
+    {
+        release();
+    }
+
+    mapped_znum_array::mapped_znum_array(mapped_znum_array &&o) noexcept
+        : mapping(o.mapping),
+          mapping_size(o.mapping_size),
+          array(o.array)
+    {
+        o.mapping = nullptr;
+        o.mapping_size = 0;
+        o.array = znum_array_view();
+    }
+
+    mapped_znum_array &mapped_znum_array::operator=(mapped_znum_array &&o) noexcept
+    {
+        if(this != &o)
+        {
+            release();
+            mapping = o.mapping;
+            mapping_size = o.mapping_size;
+            array = o.array;
+            o.mapping = nullptr;
+            o.mapping_size = 0;
+            o.array = znum_array_view();
+        }
+        return *this;
+    }
+
+    void mapped_znum_array::release()
+    {
+        if(mapping != nullptr)
+        {
+#if defined(_WIN32)
+            delete[] static_cast<uint64_t *>(mapping);
+#else
+            munmap(mapping, mapping_size);
+#endif
+        }
+        mapping = nullptr;
+        mapping_size = 0;
+        array = znum_array_view();
+    }
+
+    size_t znum_array_size(const std::vector<znum> &numbers)
+    {
+        size_t n_digits = 0;
+        for(const znum &a : numbers)
+        {
+            n_digits += a.n_digits();
+        }
+        return znum_array_header_size + (numbers.size() + 1) * sizeof(uint64_t) + n_digits * sizeof(digit_t);
+    }
+
+    static void write_le(std::ostream &os, uint64_t v, size_t n_bytes)
+    {
+        char buf[8];
+        for(size_t idx = 0; idx < n_bytes; ++idx)
+        {
+            buf[idx] = char(uint8_t(v >> (8 * idx)));
+        }
+        os.write(buf, std::streamsize(n_bytes));
+    }
+
+    void write_znum_array(std::ostream &os, const std::vector<znum> &numbers)
+    {
+        os.write(znum_array_magic, sizeof(znum_array_magic));
+        os.put(char(znum_array_version));
+        write_le(os, numbers.size(), sizeof(uint64_t));
+
+        uint64_t offset = 0;
+        for(const znum &a : numbers)
+        {
+            write_le(os, offset << 2 | uint64_t(a.signum() < 0), sizeof(uint64_t));
+            offset += a.n_digits();
+        }
+        write_le(os, offset << 2, sizeof(uint64_t));
+
+        for(const znum &a : numbers)
+        {
+            numview v = a.to_numview();
+            for(uint32_t idx = 0; idx < v.n_digits; ++idx)
+            {
+                write_le(os, v.digits[idx], sizeof(digit_t));
+            }
+        }
+    }
+
+} // namespace rqm
@@ -0,0 +1,131 @@
+#include "rqm/znum_view.h"
+#include <cstdint>
+#include <ostream>
+
+#include "basic_arithmetic.h"
+#include "numview.h"
+#include "string_conversion.h"
+
+namespace rqm
+{
+
+    znum_view::znum_view(const znum &a)
+        : _signum(a.signum()),
+          _n_digits(a.n_digits()),
+          _digits(a.to_numview().digits)
+    {}
+
+    numview znum_view::to_numview() const
+    {
+        return numview(_n_digits, _signum, _digits);
+    }
+
+    signum_t compare(znum_view a, znum_view b)
+    {
+        return compare(a.to_numview(), b.to_numview());
+    }
+
+    bool operator==(znum_view a, znum_view b)
+    {
+        return compare(a, b) == 0;
+    }
+    bool operator!=(znum_view a, znum_view b)
+    {
+        return compare(a, b) != 0;
+    }
+    bool operator<(znum_view a, znum_view b)
+    {
+        return compare(a, b) < 0;
+    }
+    bool operator<=(znum_view a, znum_view b)
+    {
+        return compare(a, b) <= 0;
+    }
+    bool operator>(znum_view a, znum_view b)
+    {
+        return compare(a, b) > 0;
+    }
+    bool operator>=(znum_view a, znum_view b)
+    {
+        return compare(a, b) >= 0;
+    }
+
+    znum operator-(znum_view a)
+    {
+        return znum(negate(a.to_numview()));
+    }
+
+    znum abs(znum_view a)
+    {
+        return znum(abs(a.to_numview()));
+    }
+
+    znum operator+(znum_view a, znum_view b)
+    {
+        znum c(znum::empty_with_n_digits(), add_digit_estimate(a.n_digits(), b.n_digits()));
+        c.update_signum_n_digits(add(c.to_numview(), a.to_numview(), b.to_numview()));
+        return c;
+    }
+
+    znum operator-(znum_view a, znum_view b)
+    {
+        znum c(znum::empty_with_n_digits(), add_digit_estimate(a.n_digits(), b.n_digits()));
+        c.update_signum_n_digits(add(c.to_numview(), a.to_numview(), negate(b.to_numview())));
+        return c;
+    }
+
+    znum operator*(znum_view a, znum_view b)
+    {
+        znum c(znum::empty_with_n_digits(), multiply_digit_estimate(a.n_digits(), b.n_digits()));
+        c.update_signum_n_digits(multiply(c.to_numview(), a.to_numview(), b.to_numview()));
+        return c;
+    }
+
+    znum operator/(znum_view a, znum_view b)
+    {
+        znum c(znum::empty_with_n_digits(), quotient_digit_estimate(a.n_digits(), 1));
+        c.update_signum_n_digits(divmod(c.to_numview(), nullptr, a.to_numview(), b.to_numview()));
+        return c;
+    }
+
+    znum operator%(znum_view a, znum_view b)
+    {
+        MAKE_TEMPORARY_NUMVIEW(quotient, quotient_digit_estimate(a.n_digits(), b.n_digits()));
+        znum c(znum::empty_with_n_digits(), modulo_digit_estimate(a.n_digits(), b.n_digits()));
+
+        numview modulo = c.to_numview();
+        quotient = divmod(quotient, &modulo, a.to_numview(), b.to_numview());
+        c.update_signum_n_digits(modulo);
+        return c;
+    }
+
+    std::ostream &operator<<(std::ostream &os, znum_view a)
+    {
+        uint32_t buf_size = to_string_buffer_estimate(a.n_digits());
+        scratch_space<char> buf(buf_size);
+        std::string_view sv = to_string(&buf[buf_size], a.to_numview());
+        return (os << sv);
+    }
+
+    std::string to_string(znum_view a, uint32_t base)
+    {
+        check_base(base);
+        uint32_t buf_size = to_string_buffer_estimate(a.n_digits(), base);
+        scratch_space<char> buf(buf_size);
+        std::string_view sv = to_string(&buf[buf_size], a.to_numview(), base);
+        return std::string(sv);
+    }
+
+    size_t hash_value(znum_view a)
+    {
+        // multiply-xorshift over the digits, seeded with the sign
+        uint64_t h = uint64_t(int64_t(a.signum())) * 0x9e3779b97f4a7c15;
+        for(uint32_t idx = 0; idx < a.n_digits(); ++idx)
+        {
+            h = (h ^ a.digits()[idx]) * 0xbf58476d1ce4e5b9;
+            h ^= h >> 31;
+        }
+        return size_t(h);
+    }
+
+} // namespace rqm
@@ -0,0 +1,59 @@
+#include "rqm/compact_znum.h"
+
+#include <gtest/gtest.h>
+#include <rapidcheck/gtest.h>
+#include <string>
+#include <utility>
+
+TEST(RQM_COMPACT_ZNUM, size)
+{
+    EXPECT_EQ(sizeof(rqm::compact_znum), 16u);
+}
+
+RC_GTEST_PROP(RQM_COMPACT_ZNUM, roundtrip_znum, (int64_t ia, uint8_t shift))
+{
+    rqm::znum a = rqm::znum(ia) << shift;
+    rqm::compact_znum c(a);
+    RC_ASSERT(c.to_znum() == a);
+    RC_ASSERT(to_string(c) == to_string(a));
+}
+
+RC_GTEST_PROP(RQM_COMPACT_ZNUM, arithmetic, (int64_t ia, int64_t ib, uint8_t shift))
+{
+    rqm::znum za = rqm::znum(ia) << (shift % 100);
+    rqm::znum zb = ib;
+    rqm::compact_znum a(za);
+    rqm::compact_znum b(zb);
+
+    RC_ASSERT((a + b).to_znum() == za + zb);
+    RC_ASSERT((a - b).to_znum() == za - zb);
+    RC_ASSERT((a * b).to_znum() == za * zb);
+    RC_ASSERT((-a).to_znum() == -za);
+    RC_ASSERT(compare(a, b) == compare(za, zb));
+    RC_ASSERT((a < b) == (za < zb));
+    RC_ASSERT((a == b) == (za == zb));
+
+    rqm::compact_znum c = a;
+    c += b;
+    RC_ASSERT(c.to_znum() == za + zb);
+    c -= b;
+    RC_ASSERT(c == a);
+    c *= b;
+    RC_ASSERT(c.to_znum() == za * zb);
+}
+
+TEST(RQM_COMPACT_ZNUM, copy_and_move)
+{
+    rqm::compact_znum big(rqm::znum(1) << 200);
+    rqm::compact_znum small = 42;
+    rqm::compact_znum c = big;
+    EXPECT_EQ(c, big);
+    c = small;
+    EXPECT_EQ(c, small);
+    c = big;
+    rqm::compact_znum d = std::move(c);
+    EXPECT_EQ(d, big);
+    EXPECT_EQ(c, 0);
+    d = std::move(small);
+    EXPECT_EQ(d, 42);
+}
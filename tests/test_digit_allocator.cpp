@@ -0,0 +1,57 @@
+#include "rqm/rqm.h"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+    int64_t n_live_blocks = 0;
+
+    rqm::digit_t *counting_allocate(uint8_t capacity_log2)
+    {
+        ++n_live_blocks;
+        return new rqm::digit_t[size_t(1) << capacity_log2];
+    }
+
+    void counting_deallocate(rqm::digit_t *ptr, uint8_t capacity_log2)
+    {
+        --n_live_blocks;
+        delete[] ptr;
+    }
+} // namespace
+
+TEST(RQM_DIGIT_ALLOCATOR, custom_allocator)
+{
+    rqm::set_digit_allocator(rqm::digit_allocator{counting_allocate, counting_deallocate});
+    {
+        rqm::znum a = rqm::znum(1) << 1000;
+        rqm::znum b = a * a;
+        EXPECT_EQ(n_live_blocks, 2);
+        EXPECT_EQ(b >> 2000, 1);
+    }
+    EXPECT_EQ(n_live_blocks, 0);
+    rqm::set_digit_allocator(rqm::new_delete_digit_allocator());
+}
+
+TEST(RQM_DIGIT_ALLOCATOR, pool_recycles_blocks)
+{
+    rqm::set_digit_allocator(rqm::pooled_digit_allocator());
+    rqm::trim_digit_pool();
+    rqm::reset_digit_pool_statistics();
+
+    rqm::znum a = rqm::znum(1) << 1000;
+    for(int i = 0; i < 100; ++i)
+    {
+        rqm::znum b = a + i;
+        EXPECT_EQ(b - a, i);
+    }
+    rqm::digit_pool_statistics stats = rqm::get_digit_pool_statistics();
+    EXPECT_GT(stats.hits, stats.misses);
+    EXPECT_GT(stats.n_cached, 0u);
+
+    rqm::trim_digit_pool();
+    EXPECT_EQ(rqm::get_digit_pool_statistics().n_cached, 0u);
+    EXPECT_EQ(rqm::get_digit_pool_statistics().cached_bytes, 0u);
+
+    // blocks from the pool may be released after switching back to plain new/delete
+    rqm::set_digit_allocator(rqm::new_delete_digit_allocator());
+}
@@ -0,0 +1,65 @@
+#include "rqm/fixed_znum.h"
+
+#include <gtest/gtest.h>
+#include <rapidcheck/gtest.h>
+#include <stdexcept>
+#include <string>
+
+using fixed512 = rqm::fixed_znum<16>;
+
+RC_GTEST_PROP(RQM_FIXED_ZNUM, roundtrip_znum, (int64_t ia, uint16_t shift))
+{
+    rqm::znum a = rqm::znum(ia) << (shift % 448);
+    fixed512 f(a);
+    RC_ASSERT(f.to_znum() == a);
+    RC_ASSERT(to_string(f) == to_string(a));
+}
+
+RC_GTEST_PROP(RQM_FIXED_ZNUM, arithmetic, (int64_t ia, int64_t ib, uint8_t shift))
+{
+    rqm::znum za = rqm::znum(ia) << shift;
+    rqm::znum zb = ib;
+    fixed512 a(za);
+    fixed512 b(zb);
+
+    RC_ASSERT((a + b).to_znum() == za + zb);
+    RC_ASSERT((a - b).to_znum() == za - zb);
+    RC_ASSERT((a * b).to_znum() == za * zb);
+    RC_ASSERT((-a).to_znum() == -za);
+    RC_ASSERT(abs(a).to_znum() == abs(za));
+    RC_ASSERT(compare(a, b) == compare(za, zb));
+    RC_ASSERT((a < b) == (za < zb));
+    RC_ASSERT((a == b) == (za == zb));
+    if(ib != 0)
+    {
+        RC_ASSERT((a / b).to_znum() == za / zb);
+        RC_ASSERT((a % b).to_znum() == za % zb);
+    }
+    if(ia != 0)
+    {
+        fixed512 c = a;
+        c /= c;
+        RC_ASSERT(c == 1);
+    }
+}
+
+TEST(RQM_FIXED_ZNUM, overflow)
+{
+    rqm::fixed_znum<2> max(rqm::znum(int64_t(-1) & INT64_MAX) * 2 + 1);
+    EXPECT_EQ(max.to_znum(), (rqm::znum(1) << 64) - 1);
+    EXPECT_THROW(max + 1, std::overflow_error);
+    EXPECT_THROW(-max - 1, std::overflow_error);
+    EXPECT_THROW(max * 2, std::overflow_error);
+    EXPECT_EQ((max - max).signum(), 0);
+    EXPECT_EQ((max + (-max)).signum(), 0);
+    EXPECT_THROW(rqm::fixed_znum<2>(rqm::znum(1) << 64), std::overflow_error);
+    EXPECT_THROW(rqm::fixed_znum<1>(int64_t(1) << 32), std::overflow_error);
+    EXPECT_THROW(max / 0, std::out_of_range);
+}
+
+TEST(RQM_FIXED_ZNUM, constexpr_arithmetic)
+{
+    constexpr rqm::fixed_znum<4> a = rqm::fixed_znum<4>(int64_t(1) << 40) * rqm::fixed_znum<4>(int64_t(1) << 40) - 1;
+    static_assert(a.n_digits() == 3, "evaluated at compile time");
+    EXPECT_EQ(a.to_znum(), (rqm::znum(1) << 80) - 1);
+}
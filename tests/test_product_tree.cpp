@@ -0,0 +1,97 @@
+#include "rqm/product_tree.h"
+
+#include <gtest/gtest.h>
+#include <rapidcheck/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+TEST(RQM_PRODUCT_TREE, product)
+{
+    EXPECT_EQ(rqm::product_tree({}).product(), 1);
+    EXPECT_TRUE(rqm::product_tree({}).empty());
+
+    std::vector<rqm::znum> leaves;
+    rqm::znum expected = 1;
+    for(int32_t idx = 1; idx <= 37; ++idx)
+    {
+        rqm::znum leaf = (rqm::znum(idx) << (idx * 5)) - idx;
+        leaves.push_back(leaf);
+        expected *= leaf;
+        rqm::product_tree tree(leaves);
+        EXPECT_EQ(tree.size(), leaves.size());
+        EXPECT_EQ(tree.product(), expected);
+    }
+}
+
+RC_GTEST_PROP(RQM_PRODUCT_TREE, remainder_tree, (std::vector<int64_t> imoduli, int64_t ix, uint16_t shift))
+{
+    std::vector<rqm::znum> moduli;
+    for(int64_t m: imoduli)
+    {
+        if(m != 0) moduli.push_back(m);
+    }
+    rqm::znum x = rqm::znum(ix) << (shift % 3000);
+    std::vector<rqm::znum> remainders = rqm::remainder_tree(x, moduli);
+    RC_ASSERT(remainders.size() == moduli.size());
+    for(size_t idx = 0; idx < moduli.size(); ++idx)
+    {
+        RC_ASSERT(remainders[idx] == x % moduli[idx]);
+    }
+}
+
+TEST(RQM_PRODUCT_TREE, remainder_tree_large)
+{
+    // moduli of mixed sizes, against a number far larger than their product
+    std::vector<rqm::znum> moduli;
+    for(int32_t idx = 0; idx < 300; ++idx)
+    {
+        moduli.push_back(rqm::next_prime(rqm::znum(idx + 1) << (idx % 7 * 40)) * (idx % 2 ? 1 : -1));
+    }
+    rqm::znum x = -(pow(rqm::znum(3), 40000) + 12345);
+    std::vector<rqm::znum> remainders = rqm::remainder_tree(x, moduli);
+    for(size_t idx = 0; idx < moduli.size(); ++idx)
+    {
+        EXPECT_EQ(remainders[idx], x % moduli[idx]) << idx;
+    }
+
+    EXPECT_THROW(rqm::remainder_tree(x, {3, 0, 5}), std::out_of_range);
+}
+
+TEST(RQM_PRODUCT_TREE, batch_gcd)
+{
+    EXPECT_TRUE(rqm::batch_gcd({}).empty());
+    EXPECT_EQ(rqm::batch_gcd({91}), std::vector<rqm::znum>{1});
+
+    // rsa-like moduli, where a few pairs were generated with a shared prime
+    std::vector<rqm::znum> primes;
+    rqm::znum p = rqm::znum(1) << 100;
+    for(int32_t idx = 0; idx < 24; ++idx)
+    {
+        p = rqm::next_prime(p + (rqm::znum(idx) << 60));
+        primes.push_back(p);
+    }
+    std::vector<rqm::znum> moduli;
+    for(int32_t idx = 0; idx < 10; ++idx)
+    {
+        moduli.push_back(primes[2 * idx] * primes[2 * idx + 1]);
+    }
+    moduli.push_back(primes[3] * primes[20]);  // shares primes[3] with moduli[1]
+    moduli.push_back(primes[21] * primes[22]); // shares nothing
+    moduli.push_back(primes[20] * primes[23]); // shares primes[20] with moduli[10]
+
+    std::vector<rqm::znum> gcds = rqm::batch_gcd(moduli);
+    ASSERT_EQ(gcds.size(), moduli.size());
+    for(size_t idx = 0; idx < moduli.size(); ++idx)
+    {
+        rqm::znum expected = 1;
+        for(size_t other = 0; other < moduli.size(); ++other)
+        {
+            if(other != idx) expected *= moduli[other];
+        }
+        EXPECT_EQ(gcds[idx], gcd(moduli[idx], expected)) << idx;
+    }
+    EXPECT_EQ(gcds[1], primes[3]);
+    EXPECT_EQ(gcds[10], primes[3] * primes[20]);
+    EXPECT_EQ(gcds[11], 1);
+    EXPECT_EQ(gcds[12], primes[20]);
+}
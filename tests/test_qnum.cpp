@@ -3,7 +3,9 @@
 #include <gtest/gtest.h>
 #include <iostream>
 #include <rapidcheck/gtest.h>
+#include <sstream>
 #include <string>
+#include <vector>
 
 TEST(RQM_QNUM, ZnumConstructor)
 {
@@ -57,6 +59,14 @@ RC_GTEST_PROP(RQM_QNUM, roundtrip_double, (double v))
 TEST(RQM_QNUM, divide_by_zero)
 {
     EXPECT_THROW(rqm::qnum(4, 0), std::out_of_range);
+
+    // a failed division leaves the number as it was
+    rqm::qnum a(3, 4);
+    EXPECT_THROW(a /= 0, std::out_of_range);
+    EXPECT_EQ(a, rqm::qnum(3, 4));
+    EXPECT_THROW(a /= rqm::qnum(0), std::out_of_range);
+    EXPECT_EQ(a, rqm::qnum(3, 4));
+    EXPECT_EQ(rqm::to_double(a), 0.75);
 }
 
 TEST(RQM_QNUM, FromString)
@@ -183,6 +193,70 @@ TEST(RQM_QNUM, DivisionQnum)
     EXPECT_EQ(result.denom(), rqm::znum(2));
 }
 
+RC_GTEST_PROP(RQM_QNUM, compound_assignment, (int64_t in1, uint32_t id1, int64_t in2, uint32_t id2))
+{
+    RC_PRE(id1 > uint32_t(0));
+    RC_PRE(id2 > uint32_t(0));
+    rqm::qnum a(in1, id1);
+    rqm::qnum b(in2, id2);
+    rqm::qnum c;
+
+    c = a;
+    c += b;
+    RC_ASSERT(c == a + b);
+    c = a;
+    c -= b;
+    RC_ASSERT(c == a - b);
+    c = a;
+    c *= b;
+    RC_ASSERT(c == a * b);
+    c = a;
+    c *= int32_t(in2);
+    RC_ASSERT(c == a * int32_t(in2));
+    c = a;
+    c += rqm::qnum(in2);
+    RC_ASSERT(c == a + rqm::qnum(in2));
+    if(in2 != 0)
+    {
+        c = a;
+        c /= b;
+        RC_ASSERT(c == a / b);
+    }
+    if(int32_t(in2) != 0)
+    {
+        c = a;
+        c /= int32_t(in2);
+        RC_ASSERT(c == a / int32_t(in2));
+    }
+    if(in1 != 0)
+    {
+        c = a;
+        c /= c;
+        RC_ASSERT(c == 1);
+    }
+}
+
+RC_GTEST_PROP(RQM_QNUM, temporary_operands, (int64_t in1, uint32_t id1, int64_t in2, uint32_t id2))
+{
+    RC_PRE(id1 > uint32_t(0));
+    RC_PRE(id2 > uint32_t(0));
+    rqm::qnum a(in1, id1);
+    rqm::qnum b(in2, id2);
+
+    rqm::qnum ab = a * b;
+    rqm::qnum a_plus_b = a + b;
+    RC_ASSERT(a * b + a == ab + a);
+    RC_ASSERT(a - (a * b) == a - ab);
+    RC_ASSERT((a + b) - (a * b) == a_plus_b - ab);
+    RC_ASSERT(-(a + b) == -a_plus_b);
+    RC_ASSERT((a + b) * 2 == 2 * (a + b));
+    RC_ASSERT((a + b) / 2 == a_plus_b / 2);
+    if(in2 != 0)
+    {
+        RC_ASSERT((a * b) / b == a);
+    }
+}
+
 RC_GTEST_PROP(RQM_QNUM, pre_increment, (int64_t in, uint32_t id))
 {
     RC_PRE(id > uint32_t(0));
@@ -230,6 +304,48 @@ TEST(RQM_QNUM, ToString)
     EXPECT_EQ(result, "1/4");
 }
 
+TEST(RQM_QNUM, ToStringAndToChars)
+{
+    EXPECT_EQ(rqm::to_string(rqm::qnum(-3, 4)), "-3/4");
+    EXPECT_EQ(rqm::to_string(rqm::qnum(5)), "5/1");
+
+    rqm::qnum r(rqm::znum(1) << 100, 3);
+    std::string expected = "1267650600228229401496703205376/3";
+    EXPECT_EQ(rqm::to_string(r), expected);
+
+    char buf[64];
+    auto [ptr, ec] = rqm::to_chars(buf, buf + sizeof(buf), r);
+    EXPECT_EQ(ec, std::errc());
+    EXPECT_EQ(std::string(buf, ptr), expected);
+
+    // the nominator fits, but the slash doesn't
+    auto [short_ptr, short_ec] = rqm::to_chars(buf, buf + 31, r);
+    EXPECT_EQ(short_ec, std::errc::value_too_large);
+    EXPECT_EQ(short_ptr, buf + 31);
+}
+
+RC_GTEST_PROP(RQM_QNUM, serialize_roundtrip, (int64_t in, uint32_t id))
+{
+    RC_PRE(id > uint32_t(0));
+    rqm::qnum r(in, id);
+    std::vector<std::byte> buf(rqm::serialized_size(r));
+    RC_ASSERT(rqm::serialize(buf.data(), buf.data() + buf.size(), r) == buf.data() + buf.size());
+
+    const std::byte *pos = buf.data();
+    rqm::qnum s = rqm::qnum::deserialize(pos, buf.data() + buf.size());
+    RC_ASSERT(s == r);
+    RC_ASSERT(s.denom() == r.denom());
+    RC_ASSERT(pos == buf.data() + buf.size());
+}
+
+TEST(RQM_QNUM, deserialize_rejects_bad_denominator)
+{
+    // a nominator of 1 followed by a denominator of zero
+    std::byte bytes[] = {std::byte(1 << 3), std::byte(1), std::byte(0), std::byte(0), std::byte(0), std::byte(0)};
+    const std::byte *pos = bytes;
+    EXPECT_THROW(rqm::qnum::deserialize(pos, bytes + sizeof(bytes)), std::invalid_argument);
+}
+
 TEST(RQM_QNUM, StreamOutput)
 {
     rqm::qnum r(1, 4);
@@ -237,3 +353,47 @@ TEST(RQM_QNUM, StreamOutput)
     os << r;
     EXPECT_EQ(os.str(), "1/4");
 }
+
+TEST(RQM_QNUM, StreamInput)
+{
+    std::istringstream is("3/-6 5 7/0 1/ 2");
+    rqm::qnum a, b, c;
+    is >> a >> b;
+    EXPECT_EQ(a, rqm::qnum(-1, 2));
+    EXPECT_EQ(b, rqm::qnum(5));
+
+    // a zero denominator fails the stream instead of throwing
+    is >> c;
+    EXPECT_TRUE(is.fail());
+    EXPECT_EQ(c, rqm::qnum(0));
+
+    // and so does a slash with nothing after it
+    is.clear();
+    is >> c;
+    EXPECT_TRUE(is.fail());
+
+    std::stringstream ss;
+    rqm::qnum d(rqm::znum(-7) << 200, rqm::znum(3) << 100);
+    ss << d;
+    ss >> c;
+    EXPECT_EQ(c, d);
+}
+
+TEST(RQM_QNUM, Pow)
+{
+    EXPECT_EQ(pow(rqm::qnum(2, 3), 3), rqm::qnum(8, 27));
+    EXPECT_EQ(pow(rqm::qnum(-2, 3), 3), rqm::qnum(-8, 27));
+    EXPECT_EQ(pow(rqm::qnum(-2, 3), -3), rqm::qnum(-27, 8));
+    EXPECT_EQ(pow(rqm::qnum(-2, 3), -2), rqm::qnum(9, 4));
+    EXPECT_EQ(pow(rqm::qnum(5, 7), 0), rqm::qnum(1));
+    EXPECT_EQ(pow(rqm::qnum(0), 4), rqm::qnum(0));
+    EXPECT_THROW(pow(rqm::qnum(0), -1), std::out_of_range);
+
+    rqm::qnum a(rqm::znum(-7) << 50, 3);
+    rqm::qnum expected = 1;
+    for(uint32_t idx = 0; idx < 9; ++idx)
+    {
+        expected /= a;
+    }
+    EXPECT_EQ(pow(a, -9), expected);
+}
@@ -1,9 +1,13 @@
 #include "rqm/rqm.h"
 
+#include <algorithm>
+#include <cctype>
 #include <gtest/gtest.h>
 #include <iostream>
 #include <rapidcheck/gtest.h>
+#include <sstream>
 #include <string>
+#include <vector>
 
 TEST(RQM_ZNUM, instantiation)
 {
@@ -11,6 +15,30 @@ TEST(RQM_ZNUM, instantiation)
     EXPECT_EQ(one.to_int64_t(), 1);
 }
 
+TEST(RQM_ZNUM, literals)
+{
+    using namespace rqm::literals;
+    EXPECT_EQ(0_z, 0);
+    EXPECT_EQ(42_z, 42);
+    EXPECT_EQ(-42_z, -42);
+    EXPECT_EQ(123456789012345678901234567890_z, rqm::znum::from_string("123456789012345678901234567890"));
+    EXPECT_EQ(1'000'000'000'000'000'000'000_z, rqm::znum::from_string("1000000000000000000000"));
+    EXPECT_EQ(0xffff'ffff'ffff'ffff'ffff_z, (rqm::znum(1) << 80) - 1);
+    EXPECT_EQ(0x0000'0001'0000'0000_z, rqm::znum(1) << 32);
+    EXPECT_EQ(0b1000000000000000000000000000000000000000000000000000000000000000000_z, rqm::znum(1) << 66);
+    EXPECT_EQ(0777_z, 511);
+    EXPECT_EQ(to_string(340282366920938463463374607431768211456_z * 340282366920938463463374607431768211456_z),
+              "115792089237316195423570985008687907853269984665640564039457584007913129639936");
+}
+
+// constant-initialised, so there is no startup code for it to run before any other static initialiser
+static rqm::znum static_constant = -1234567890123;
+
+TEST(RQM_ZNUM, constant_initialisation)
+{
+    EXPECT_EQ(static_constant, rqm::znum::from_string("-1234567890123"));
+}
+
 TEST(RQM_ZNUM, simple_add)
 {
     int64_t ia = 1;
@@ -118,6 +146,27 @@ RC_GTEST_PROP(RQM_ZNUM, sub, (int64_t ia, int64_t ib))
     RC_ASSERT(c == (ia - ib));
 }
 
+RC_GTEST_PROP(RQM_ZNUM, add_sub_beyond_int64, (int64_t ia, int64_t ib))
+{
+    // the sums may overflow 64 bits, which the fast path has to handle. check against the general path by going through a larger operand
+    rqm::znum a = ia;
+    rqm::znum b = ib;
+    rqm::znum big = rqm::znum(1) << 100;
+    RC_ASSERT(a + b == ((big + a) + b) - big);
+    RC_ASSERT(a - b == ((big + a) - b) - big);
+    RC_ASSERT((a + b) - b == a);
+}
+
+RC_GTEST_PROP(RQM_ZNUM, mul_full_double_digit, (uint32_t a0, uint32_t a1, uint32_t b0, uint32_t b1))
+{
+    // two-digit operands, with products up to 128 bits. compare against the general path by moving the operands out of fast path range
+    rqm::znum a = (rqm::znum(a1) << 32) + rqm::znum(a0);
+    rqm::znum b = -((rqm::znum(b1) << 32) + rqm::znum(b0));
+    rqm::znum c = a * b;
+    RC_ASSERT(c == (((a << 64) * b) >> 64));
+    RC_ASSERT(c.n_bits() <= a.n_bits() + b.n_bits());
+}
+
 RC_GTEST_PROP(RQM_ZNUM, mul_small, (int32_t ia32, int32_t ib32))
 {
     int64_t ia = ia32;
@@ -209,6 +258,55 @@ RC_GTEST_PROP(RQM_ZNUM, modulo, (int64_t ia, int64_t ib))
     RC_ASSERT(quotient == (ia % ib));
 }
 
+RC_GTEST_PROP(RQM_ZNUM, divmod, (int64_t ia, int64_t ib, uint8_t shift))
+{
+    RC_PRE(ib != 0);
+    rqm::znum a = rqm::znum(ia) << shift;
+    rqm::znum b = ib;
+    auto [q, r] = divmod(a, b);
+    RC_ASSERT(q == a / b);
+    RC_ASSERT(r == a % b);
+
+    rqm::znum fq, fr, cq, cr;
+    fdiv_qr(fq, fr, a, b);
+    RC_ASSERT(fq * b + fr == a);
+    RC_ASSERT(abs(fr) < abs(b));
+    RC_ASSERT(fr.signum() == 0 || fr.signum() == b.signum());
+    cdiv_qr(cq, cr, a, b);
+    RC_ASSERT(cq * b + cr == a);
+    RC_ASSERT(abs(cr) < abs(b));
+    RC_ASSERT(cr.signum() == 0 || cr.signum() == -b.signum());
+
+    // the outputs doubling as inputs
+    rqm::znum x = a, y = b;
+    tdiv_qr(x, y, x, y);
+    RC_ASSERT(x == q);
+    RC_ASSERT(y == r);
+    x = a, y = b;
+    fdiv_qr(y, x, x, y);
+    RC_ASSERT(y == fq);
+    RC_ASSERT(x == fr);
+}
+
+RC_GTEST_PROP(RQM_ZNUM, divmod_with_digit, (int64_t ia, int32_t ib, uint8_t shift))
+{
+    RC_PRE(ib != 0);
+    rqm::znum a = rqm::znum(ia) << shift;
+    auto [q, r] = divmod(a, ib);
+    RC_ASSERT(q == a / ib);
+    RC_ASSERT(r == a % ib);
+
+    rqm::znum fq, cq;
+    int32_t fr, cr;
+    fdiv_qr(fq, fr, a, ib);
+    RC_ASSERT(fq * ib + fr == a);
+    RC_ASSERT(fr == 0 || (fr < 0) == (ib < 0));
+    cdiv_qr(cq, cr, a, ib);
+    RC_ASSERT(cq * ib + cr == a);
+    RC_ASSERT(cr == 0 || (cr < 0) != (ib < 0));
+    RC_ASSERT(fq == a / rqm::znum(ib) - (fr != r));
+}
+
 RC_GTEST_PROP(RQM_ZNUM, divide_by_itself, (int64_t ia))
 {
     RC_PRE(ia != 0);
@@ -244,6 +342,76 @@ RC_GTEST_PROP(RQM_ZNUM, from_string, (int64_t ia))
     RC_ASSERT(a == ia);
 }
 
+TEST(RQM_ZNUM, large_to_string)
+{
+    // long enough to be split by powers of ten, with zero runs that have to come out padded on either side of the splits
+    for(uint32_t n_decimals: {300u, 2000u, 20000u})
+    {
+        std::string nines(n_decimals, '9');
+        std::string power = "1" + std::string(n_decimals, '0');
+        std::string power_plus_one = "1" + std::string(n_decimals - 1, '0') + "1";
+        EXPECT_EQ(rqm::to_string(rqm::znum::from_string(nines)), nines);
+        EXPECT_EQ(rqm::to_string(rqm::znum::from_string(power)), power);
+        EXPECT_EQ(rqm::to_string(-rqm::znum::from_string(power_plus_one)), "-" + power_plus_one);
+    }
+    std::string digits;
+    for(uint32_t idx = 0; idx < 5000; ++idx)
+    {
+        digits += char('1' + (idx * 7919) % 9);
+    }
+    EXPECT_EQ(rqm::to_string(rqm::znum::from_string(digits)), digits);
+}
+
+TEST(RQM_ZNUM, large_from_string)
+{
+    // long enough to be parsed in pieces and put back together with powers of ten
+    rqm::znum power = 1;
+    for(uint32_t idx = 0; idx < 3000; ++idx)
+    {
+        power *= 10;
+    }
+    EXPECT_EQ(rqm::znum::from_string("1" + std::string(3000, '0')), power);
+    EXPECT_EQ(rqm::znum::from_string(std::string(3000, '9')), power - 1);
+    EXPECT_EQ(rqm::znum::from_string("-" + std::string(2000, '0') + "1" + std::string(3000, '0')), -power);
+
+    // a bad character is caught wherever it ends up after splitting
+    for(uint32_t bad_pos: {0u, 1234u, 2999u})
+    {
+        std::string s(3000, '5');
+        s[bad_pos] = 'x';
+        EXPECT_THROW(rqm::znum::from_string(s), std::invalid_argument);
+    }
+}
+
+RC_GTEST_PROP(RQM_ZNUM, large_divide, (int64_t ia, int64_t ib, int64_t ic, uint16_t shift_a, uint16_t shift_b))
+{
+    // long enough for recursive division, so the quotient and remainder are rebuilt and checked against their definition
+    RC_PRE(ib != 0);
+    rqm::znum a = (rqm::znum(ia) << (3000 + shift_a)) - ic;
+    rqm::znum b = (rqm::znum(ib) << (3000 + shift_b % 3000)) + ic;
+    rqm::znum q = a / b;
+    rqm::znum r = a % b;
+    RC_ASSERT(q * b + r == a);
+    RC_ASSERT(abs(r) < abs(b));
+    RC_ASSERT(r == 0 || r.signum() == a.signum());
+    RC_ASSERT((a * b) / b == a);
+}
+
+RC_GTEST_PROP(RQM_ZNUM, to_chars, (int64_t ia, uint8_t shift))
+{
+    rqm::znum a = rqm::znum(ia) << shift;
+    std::string expected = rqm::to_string(a);
+    std::vector<char> buf(rqm::to_chars_max_size(a));
+    auto [ptr, ec] = rqm::to_chars(buf.data(), buf.data() + buf.size(), a);
+    RC_ASSERT(ec == std::errc());
+    RC_ASSERT(std::string(buf.data(), ptr) == expected);
+
+    // one character short doesn't fit
+    auto [short_ptr, short_ec] = rqm::to_chars(buf.data(), buf.data() + expected.size() - 1, a);
+    RC_ASSERT(short_ec == std::errc::value_too_large);
+    RC_ASSERT(short_ptr == buf.data() + expected.size() - 1);
+}
+
 TEST(RQM_ZNUM, from_string_edge_cases)
 {
     EXPECT_THROW(rqm::znum::from_string(""), std::invalid_argument);
@@ -252,6 +420,192 @@ TEST(RQM_ZNUM, from_string_edge_cases)
     EXPECT_THROW(rqm::znum::from_string("4123*"), std::invalid_argument);
 }
 
+TEST(RQM_ZNUM, to_string_bases)
+{
+    rqm::znum a = -(rqm::znum(0xdeadbeefcafe) << 64);
+    EXPECT_EQ(rqm::to_string(a, 16), "-deadbeefcafe0000000000000000");
+    EXPECT_EQ(rqm::to_string(rqm::znum(255), 2), "11111111");
+    EXPECT_EQ(rqm::to_string(rqm::znum(-511), 8), "-777");
+    EXPECT_EQ(rqm::to_string(rqm::znum(1) << 100, 32), "1" + std::string(20, '0'));
+    EXPECT_EQ(rqm::to_string(rqm::znum(35), 36), "z");
+    EXPECT_EQ(rqm::to_string(rqm::znum(0), 7), "0");
+    EXPECT_EQ(rqm::to_string(rqm::znum(3) * 3 * 3 * 3 * 3, 3), "100000");
+    EXPECT_THROW(rqm::to_string(a, 1), std::invalid_argument);
+    EXPECT_THROW(rqm::to_string(a, 37), std::invalid_argument);
+}
+
+RC_GTEST_PROP(RQM_ZNUM, bases_roundtrip, (int64_t ia, uint16_t shift, uint8_t base_offset))
+{
+    // long enough in every base to go through both the linear and the divide and conquer paths
+    uint32_t base = 2 + base_offset % 35;
+    rqm::znum a = (rqm::znum(ia) << shift) + ia;
+    std::string s = rqm::to_string(a, base);
+    RC_ASSERT(rqm::znum::from_string(s, base) == a);
+    std::transform(s.begin(), s.end(), s.begin(), [](char c) { return std::toupper(c); });
+    RC_ASSERT(rqm::znum::from_string(s, base) == a);
+}
+
+TEST(RQM_ZNUM, from_string_bases)
+{
+    EXPECT_EQ(rqm::znum::from_string("-DeadBeef", 16), -0xdeadbeefll);
+    EXPECT_EQ(rqm::znum::from_string("1" + std::string(64, '0'), 2), rqm::znum(1) << 64);
+    EXPECT_EQ(rqm::znum::from_string("zz", 36), 36 * 36 - 1);
+    EXPECT_THROW(rqm::znum::from_string("102", 2), std::invalid_argument);
+    EXPECT_THROW(rqm::znum::from_string("fg", 16), std::invalid_argument);
+    EXPECT_THROW(rqm::znum::from_string("0x10", 16), std::invalid_argument);
+    EXPECT_THROW(rqm::znum::from_string("10", 0), std::invalid_argument);
+}
+
+TEST(RQM_ZNUM, from_string_checks_every_character)
+{
+    // characters just outside '0'..'9', and bytes that only differ from a decimal in the high bits, at every position of a few chunks
+    for(char bad: {'/', ':', ' ', '\0', char(0xb5), char(0x35 + 0x40)})
+    {
+        for(uint32_t pos = 0; pos < 30; ++pos)
+        {
+            std::string s = "123456789012345678901234567890";
+            s[pos] = bad;
+            EXPECT_THROW(rqm::znum::from_string(s), std::invalid_argument);
+        }
+    }
+    EXPECT_EQ(rqm::znum::from_string("000000000000000000000000000042"), 42);
+    EXPECT_EQ(rqm::znum::from_string("-99999999999999999999"), -(rqm::znum(10000000000) * rqm::znum(10000000000) - 1));
+}
+
+RC_GTEST_PROP(RQM_ZNUM, serialize_roundtrip, (int64_t ia, uint16_t shift))
+{
+    rqm::znum a = (rqm::znum(ia) << (shift % 2000)) + ia;
+    std::vector<std::byte> buf(rqm::serialized_size(a));
+    std::byte *end = rqm::serialize(buf.data(), buf.data() + buf.size(), a);
+    RC_ASSERT(end == buf.data() + buf.size());
+
+    const std::byte *pos = buf.data();
+    RC_ASSERT(rqm::znum::deserialize(pos, buf.data() + buf.size()) == a);
+    RC_ASSERT(pos == buf.data() + buf.size());
+}
+
+TEST(RQM_ZNUM, serialize_format)
+{
+    // small numbers get a one-byte header, and the digits follow least significant byte first
+    rqm::znum a = -0x123456789ll;
+    std::vector<std::byte> buf(rqm::serialized_size(a));
+    EXPECT_EQ(buf.size(), 9u);
+    rqm::serialize(buf.data(), buf.data() + buf.size(), a);
+    EXPECT_EQ(buf[0], std::byte(2 << 3 | 1));
+    EXPECT_EQ(buf[1], std::byte(0x89));
+    EXPECT_EQ(buf[5], std::byte(0x01));
+    EXPECT_EQ(rqm::serialized_size(rqm::znum(0)), 1u);
+
+    // several numbers back to back
+    std::vector<rqm::znum> values = {0, 1, -1, rqm::znum(1) << 1000, a};
+    std::vector<std::byte> stream;
+    for(const rqm::znum &v: values)
+    {
+        size_t offset = stream.size();
+        stream.resize(offset + rqm::serialized_size(v));
+        rqm::serialize(stream.data() + offset, stream.data() + stream.size(), v);
+    }
+    const std::byte *pos = stream.data();
+    for(const rqm::znum &v: values)
+    {
+        EXPECT_EQ(rqm::znum::deserialize(pos, stream.data() + stream.size()), v);
+    }
+    EXPECT_EQ(pos, stream.data() + stream.size());
+}
+
+RC_GTEST_PROP(RQM_ZNUM, stream_roundtrip, (int64_t ia, uint16_t shift))
+{
+    rqm::znum a = rqm::znum(ia) << shift;
+    std::stringstream ss;
+    ss << a << " " << -a;
+    rqm::znum b, c;
+    ss >> b >> c;
+    RC_ASSERT(b == a);
+    RC_ASSERT(c == -a);
+}
+
+TEST(RQM_ZNUM, large_stream_roundtrip)
+{
+    // big enough to stream out in pieces, and to be read back as many blocks of characters merged together
+    rqm::znum a = (rqm::znum(-3) << 100000) + 12345;
+    std::stringstream ss;
+    ss << a;
+    EXPECT_EQ(ss.str(), to_string(a));
+
+    rqm::znum b;
+    ss >> b;
+    EXPECT_EQ(b, a);
+    EXPECT_TRUE(ss.eof());
+
+    // every number of leftover characters after the full blocks
+    for(uint32_t n_chars: {2303u, 2304u, 2305u, 4608u, 4617u, 7000u})
+    {
+        std::string s = "1" + std::string(n_chars - 1, '0');
+        std::istringstream is(s);
+        rqm::znum c;
+        is >> c;
+        EXPECT_EQ(c, rqm::znum::from_string(s));
+    }
+}
+
+TEST(RQM_ZNUM, stream_input)
+{
+    std::istringstream is("  42abc -7 - x");
+    rqm::znum a, b;
+    is >> a;
+    EXPECT_EQ(a, 42);
+    EXPECT_EQ(is.get(), 'a');
+    is.ignore(2);
+    is >> b;
+    EXPECT_EQ(b, -7);
+
+    // a lone minus sign is no number, and leaves the target alone
+    is >> b;
+    EXPECT_TRUE(is.fail());
+    EXPECT_EQ(b, -7);
+
+    // the field width still applies to large numbers
+    rqm::znum c = rqm::znum(1) << 40000;
+    std::ostringstream os;
+    os.width(20000);
+    os.fill('*');
+    os << c;
+    std::string padded = os.str();
+    ASSERT_EQ(padded.size(), 20000u);
+    EXPECT_EQ(padded.substr(0, 20000 - to_string(c).size()), std::string(20000 - to_string(c).size(), '*'));
+    EXPECT_EQ(padded.substr(20000 - to_string(c).size()), to_string(c));
+}
+
+TEST(RQM_ZNUM, serialize_errors)
+{
+    rqm::znum a = rqm::znum(1) << 100;
+    std::vector<std::byte> buf(rqm::serialized_size(a));
+    EXPECT_THROW(rqm::serialize(buf.data(), buf.data() + buf.size() - 1, a), std::length_error);
+    rqm::serialize(buf.data(), buf.data() + buf.size(), a);
+
+    // truncated anywhere, including inside the header
+    for(size_t len = 0; len < buf.size(); ++len)
+    {
+        const std::byte *pos = buf.data();
+        EXPECT_THROW(rqm::znum::deserialize(pos, buf.data() + len), std::invalid_argument);
+    }
+
+    // a zero top digit, a negative zero, an unknown version, an overlong header for one digit, and a header with bits past 64
+    std::byte zero_top[] = {std::byte(1 << 3), std::byte(0), std::byte(0), std::byte(0), std::byte(0)};
+    std::byte negative_zero[] = {std::byte(1)};
+    std::byte future_version[] = {std::byte(1 << 1)};
+    std::byte overlong[] = {std::byte(0x80 | 1 << 3), std::byte(0), std::byte(1), std::byte(0), std::byte(0), std::byte(0)};
+    std::byte too_wide[] = {std::byte(0x80), std::byte(0x80), std::byte(0x80), std::byte(0x80), std::byte(0x80),
+                            std::byte(0x80), std::byte(0x80), std::byte(0x80), std::byte(0x80), std::byte(2)};
+    for(auto &bytes: {std::vector<std::byte>(std::begin(zero_top), std::end(zero_top)), std::vector<std::byte>(std::begin(negative_zero), std::end(negative_zero)),
+                      std::vector<std::byte>(std::begin(future_version), std::end(future_version)), std::vector<std::byte>(std::begin(overlong), std::end(overlong)),
+                      std::vector<std::byte>(std::begin(too_wide), std::end(too_wide))})
+    {
+        const std::byte *pos = bytes.data();
+        EXPECT_THROW(rqm::znum::deserialize(pos, bytes.data() + bytes.size()), std::invalid_argument);
+    }
+}
+
 TEST(RQM_ZNUM, n_bits)
 {
     EXPECT_EQ(rqm::znum(0).n_bits(), 0);
@@ -321,6 +675,311 @@ RC_GTEST_PROP(RQM_ZNUM, shift_left_right_returns_same, (int64_t ia, uint16_t ib)
     RC_ASSERT(a == a3);
 }
 
+RC_GTEST_PROP(RQM_ZNUM, bitwise, (int64_t ia, int64_t ib, uint16_t shift))
+{
+    rqm::znum a = ia;
+    rqm::znum b = ib;
+    RC_ASSERT((a & b) == (ia & ib));
+    RC_ASSERT((a | b) == (ia | ib));
+    RC_ASSERT((a ^ b) == (ia ^ ib));
+    RC_ASSERT(~a == ~ia);
+
+    // shifting both operands left shifts the result, and takes them past the native fast paths
+    rqm::znum sa = a << shift;
+    rqm::znum sb = b << shift;
+    RC_ASSERT((sa & sb) == (a & b) << shift);
+    RC_ASSERT((sa | sb) == (a | b) << shift);
+    RC_ASSERT((sa ^ sb) == (a ^ b) << shift);
+    RC_ASSERT((sa ^ sb) == (sa | sb) - (sa & sb));
+    RC_ASSERT(~sa == -sa - 1);
+
+    // and against a long number of mixed sign, the low bits behave like the native ones
+    rqm::znum big = (rqm::znum(ia) << 200) + b;
+    RC_ASSERT(((big & 0xffffffff) == (ib & 0xffffffff)));
+    RC_ASSERT(((big | sa) >> 200) == (((big >> 200) | (sa >> 200))));
+
+    rqm::znum c = sa;
+    c &= sb;
+    RC_ASSERT(c == (sa & sb));
+    c = sa;
+    c |= sb;
+    RC_ASSERT(c == (sa | sb));
+    c = sa;
+    c ^= sb;
+    RC_ASSERT(c == (sa ^ sb));
+    c ^= c;
+    RC_ASSERT(c == 0);
+}
+
+RC_GTEST_PROP(RQM_ZNUM, bits, (int64_t ia, uint8_t bit, uint8_t shift))
+{
+    rqm::znum a = rqm::znum(ia) << shift;
+    uint32_t b = bit + shift;
+    bool expected = bit < 64 ? ((ia >> bit) & 1) != 0 : ia < 0;
+    RC_ASSERT(test_bit(a, b) == expected);
+
+    rqm::znum set = a;
+    set.set_bit(b);
+    RC_ASSERT(set == (a | (rqm::znum(1) << b)));
+    RC_ASSERT(test_bit(set, b));
+
+    rqm::znum cleared = a;
+    cleared.clear_bit(b);
+    RC_ASSERT(cleared == (a & ~(rqm::znum(1) << b)));
+    RC_ASSERT(!test_bit(cleared, b));
+
+    uint64_t expected_popcount = ia < 0 ? UINT64_MAX : __builtin_popcountll(ia);
+    RC_ASSERT(popcount(a) == expected_popcount);
+    RC_ASSERT(hamming_distance(a, set) == (expected ? 0u : 1u));
+    RC_ASSERT(hamming_distance(a, ~a) == UINT64_MAX);
+    if(ia >= 0) RC_ASSERT(hamming_distance(a, rqm::znum(0)) == popcount(a));
+}
+
+RC_GTEST_PROP(RQM_ZNUM, pow, (int64_t ia, uint8_t exp, uint8_t shift))
+{
+    rqm::znum a = rqm::znum(ia) << (shift % 100);
+    rqm::znum expected = 1;
+    for(uint32_t idx = 0; idx < exp; ++idx)
+    {
+        expected *= a;
+    }
+    RC_ASSERT(pow(a, exp) == expected);
+}
+
+TEST(RQM_ZNUM, pow_edge_cases)
+{
+    EXPECT_EQ(pow(rqm::znum(0), 0), 1);
+    EXPECT_EQ(pow(rqm::znum(0), 5), 0);
+    EXPECT_EQ(pow(rqm::znum(-1), 1000001), -1);
+    EXPECT_EQ(pow(rqm::znum(-2), 101), -(rqm::znum(1) << 101));
+    EXPECT_EQ(pow(rqm::znum(10), 30), rqm::znum::from_string("1" + std::string(30, '0')));
+    EXPECT_EQ(pow(rqm::znum(-12), 3), -1728);
+
+    // large enough for the squarings to go through karatsuba
+    rqm::znum three_to_the_20000 = pow(rqm::znum(3), 20000);
+    EXPECT_EQ(three_to_the_20000, pow(pow(rqm::znum(3), 100), 200));
+    EXPECT_EQ(three_to_the_20000 % 1000000007, 883496652);
+
+    EXPECT_THROW(pow(rqm::znum(3), uint64_t(1) << 40), std::overflow_error);
+    EXPECT_THROW(pow(rqm::znum(2), uint64_t(1) << 33), std::overflow_error);
+}
+
+RC_GTEST_PROP(RQM_ZNUM, sqrtrem, (uint64_t ia, uint64_t ib, uint16_t shift))
+{
+    rqm::znum a = abs(((rqm::znum(ia) << (shift % 3000)) * rqm::znum(ib)) + rqm::znum(ib));
+    auto [root, rem] = sqrtrem(a);
+    RC_ASSERT(root * root + rem == a);
+    RC_ASSERT(rem >= 0);
+    RC_ASSERT(rem <= 2 * root);
+    RC_ASSERT(isqrt(a) == root);
+    RC_ASSERT(is_perfect_square(a) == (rem == 0));
+    RC_ASSERT(is_perfect_square(a * a));
+    RC_ASSERT(isqrt(a * a) == abs(a));
+}
+
+RC_GTEST_PROP(RQM_ZNUM, iroot, (int64_t ia, uint16_t shift, uint8_t k))
+{
+    RC_PRE(k >= 1);
+    rqm::znum a = (rqm::znum(ia) << (shift % 2000)) + ia;
+    RC_PRE(a >= 0 || k % 2 == 1);
+    rqm::znum root = iroot(a, k);
+    rqm::znum next = root + (a < 0 ? -1 : 1);
+    RC_ASSERT(abs(pow(root, k)) <= abs(a));
+    RC_ASSERT(abs(pow(next, k)) > abs(a));
+    RC_ASSERT(iroot(pow(a, k), k) == a);
+}
+
+TEST(RQM_ZNUM, roots_edge_cases)
+{
+    EXPECT_EQ(isqrt(rqm::znum(0)), 0);
+    EXPECT_EQ(isqrt(rqm::znum(1)), 1);
+    EXPECT_EQ(isqrt(rqm::znum(99)), 9);
+    EXPECT_EQ(isqrt(rqm::znum(100)), 10);
+    EXPECT_EQ(isqrt((rqm::znum(1) << 128) - 1), (rqm::znum(1) << 64) - 1);
+    EXPECT_EQ(iroot(rqm::znum(-27), 3), -3);
+    EXPECT_EQ(iroot(rqm::znum(-26), 3), -2);
+    EXPECT_EQ(iroot(rqm::znum(1000), 1000), 1);
+    EXPECT_THROW(isqrt(rqm::znum(-1)), std::domain_error);
+    EXPECT_THROW(iroot(rqm::znum(-16), 4), std::domain_error);
+    EXPECT_THROW(iroot(rqm::znum(16), 0), std::domain_error);
+}
+
+TEST(RQM_ZNUM, perfect_powers)
+{
+    for(int64_t v = -1000; v <= 1000; ++v)
+    {
+        bool square = false, power = v == 0 || v == 1 || v == -1;
+        for(int64_t m = 0; m * m <= v; ++m)
+        {
+            square = square || m * m == v;
+        }
+        for(int64_t m = 2; m <= 32; ++m)
+        {
+            for(int64_t p = m * m; p <= 1000; p *= m)
+            {
+                power = power || p == v;
+                // odd powers of negative numbers
+                if(p == -v)
+                {
+                    int64_t exp = 0;
+                    for(int64_t q = 1; q < p; q *= m)
+                    {
+                        ++exp;
+                    }
+                    power = power || exp % 2 == 1;
+                }
+            }
+        }
+        EXPECT_EQ(is_perfect_square(rqm::znum(v)), square) << v;
+        EXPECT_EQ(is_perfect_power(rqm::znum(v)), power) << v;
+    }
+
+    rqm::znum big = pow(rqm::znum(12345678901ll), 37);
+    EXPECT_TRUE(is_perfect_power(big));
+    EXPECT_TRUE(is_perfect_power(-big));
+    EXPECT_FALSE(is_perfect_power(big + 1));
+    EXPECT_FALSE(is_perfect_square(big));
+    EXPECT_TRUE(is_perfect_square(big * big));
+    EXPECT_FALSE(is_perfect_power(-pow(rqm::znum(12345678901ll), 2)));
+    EXPECT_TRUE(is_perfect_power(pow(rqm::znum(2), 1000) * pow(rqm::znum(3), 500)));
+
+    // roots near 2^49, where the floating-point estimate of the root is off by several units
+    rqm::znum r49 = 562949953421314ll;
+    EXPECT_TRUE(is_perfect_power(pow(r49, 3)));
+    EXPECT_TRUE(is_perfect_power(-pow(r49, 3)));
+    EXPECT_FALSE(is_perfect_power(pow(r49, 3) + 1));
+    EXPECT_TRUE(is_perfect_power(pow(rqm::znum(562949953421231ll), 5)));
+    EXPECT_TRUE(is_perfect_power(-pow(rqm::znum(562949953421231ll), 5)));
+}
+
+RC_GTEST_PROP(RQM_ZNUM, perfect_power_of_large_root, (uint64_t ir, uint8_t ip, bool negative))
+{
+    // roots of 40 to 60 bits, around where the root stops fitting in a double's mantissa
+    static const uint32_t exponents[] = {3, 5, 7, 11, 13};
+    uint32_t n_root_bits = 40 + ip % 21;
+    uint32_t p = exponents[ip / 21 % 5];
+    rqm::znum r = int64_t((ir >> (64 - n_root_bits)) | (uint64_t(1) << (n_root_bits - 1)));
+    rqm::znum a = pow(negative ? -r : r, p);
+    RC_ASSERT(is_perfect_power(a));
+}
+
+TEST(RQM_ZNUM, factorial)
+{
+    rqm::znum expected = 1;
+    for(uint32_t n = 0; n <= 600; ++n)
+    {
+        if(n > 0) expected *= int32_t(n);
+        EXPECT_EQ(rqm::factorial(n), expected) << n;
+    }
+    EXPECT_EQ(rqm::factorial(20), rqm::znum(2432902008176640000ll));
+    EXPECT_EQ(to_string(rqm::factorial(30)), "265252859812191058636308480000000");
+
+    // the trailing zeros of n! in base 10 come from the fives
+    rqm::znum f = rqm::factorial(10000);
+    EXPECT_EQ(countr_zero(f), 10000u - 5u);
+    std::string s = to_string(f);
+    EXPECT_EQ(s.size(), 35660u);
+    EXPECT_EQ(s.size() - s.find_last_not_of('0') - 1, 2499u);
+}
+
+TEST(RQM_ZNUM, binomial)
+{
+    // pascal's triangle
+    std::vector<rqm::znum> row = {1};
+    for(uint32_t n = 0; n <= 300; ++n)
+    {
+        for(uint32_t k = 0; k <= n; ++k)
+        {
+            EXPECT_EQ(rqm::binomial(n, k), row[k]) << n << " " << k;
+        }
+        EXPECT_EQ(rqm::binomial(n, n + 1), 0);
+        std::vector<rqm::znum> next(n + 2);
+        next[0] = next[n + 1] = 1;
+        for(uint32_t k = 1; k <= n; ++k)
+        {
+            next[k] = row[k - 1] + row[k];
+        }
+        row = std::move(next);
+    }
+    EXPECT_EQ(rqm::binomial(5000, 2000) * rqm::factorial(2000) * rqm::factorial(3000), rqm::factorial(5000));
+}
+
+TEST(RQM_ZNUM, multinomial)
+{
+    EXPECT_EQ(rqm::multinomial({}), 1);
+    EXPECT_EQ(rqm::multinomial({7}), 1);
+    EXPECT_EQ(rqm::multinomial({3, 4}), rqm::binomial(7, 3));
+    EXPECT_EQ(rqm::multinomial({1, 4, 4, 2}), 34650); // mississippi
+    EXPECT_EQ(rqm::multinomial({0, 5, 0, 6, 0}), rqm::binomial(11, 5));
+
+    std::vector<uint32_t> ks = {300, 200, 700, 1, 0, 55};
+    rqm::znum product = 1;
+    uint32_t n = 0;
+    for(uint32_t k: ks)
+    {
+        product *= rqm::factorial(k);
+        n += k;
+    }
+    EXPECT_EQ(rqm::multinomial(ks) * product, rqm::factorial(n));
+    EXPECT_THROW(rqm::multinomial({UINT32_MAX, 1}), std::overflow_error);
+}
+
+TEST(RQM_ZNUM, is_probable_prime)
+{
+    // against a sieve, across the end of the trial division range at 2^20
+    uint32_t limit = (1 << 20) + 50000;
+    std::vector<bool> composite(limit);
+    composite[0] = composite[1] = true;
+    for(uint32_t p = 2; p * p < limit; ++p)
+    {
+        if(composite[p]) continue;
+        for(uint32_t multiple = p * p; multiple < limit; multiple += p)
+        {
+            composite[multiple] = true;
+        }
+    }
+    for(uint32_t v = 0; v < limit; v += v < 100000 ? 1 : 7)
+    {
+        EXPECT_EQ(is_probable_prime(rqm::znum(int64_t(v))), !composite[v]) << v;
+    }
+    EXPECT_FALSE(is_probable_prime(rqm::znum(-7)));
+
+    // mersenne numbers, of which these exponents give primes
+    for(uint32_t p: {31, 61, 89, 107, 127, 521, 607, 1279})
+    {
+        rqm::znum m = (rqm::znum(1) << p) - 1;
+        EXPECT_TRUE(is_probable_prime(m)) << p;
+        EXPECT_TRUE(is_probable_prime(m, 5)) << p;
+    }
+    for(uint32_t p: {67, 101, 257})
+    {
+        EXPECT_FALSE(is_probable_prime((rqm::znum(1) << p) - 1)) << p;
+    }
+
+    // strong pseudoprimes to base 2 and beyond, which the lucas test has to catch
+    for(const char *spsp: {"3215031751", "3825123056546413051", "318665857834031151167461", "3317044064679887385961981"})
+    {
+        EXPECT_FALSE(is_probable_prime(rqm::znum::from_string(spsp))) << spsp;
+    }
+    rqm::znum m61 = (rqm::znum(1) << 61) - 1;
+    rqm::znum m89 = (rqm::znum(1) << 89) - 1;
+    EXPECT_FALSE(is_probable_prime(m61 * m89));
+    EXPECT_FALSE(is_probable_prime(m89 * m89));
+}
+
+TEST(RQM_ZNUM, next_prime)
+{
+    EXPECT_EQ(rqm::next_prime(-5), 2);
+    EXPECT_EQ(rqm::next_prime(0), 2);
+    EXPECT_EQ(rqm::next_prime(1), 2);
+    EXPECT_EQ(rqm::next_prime(2), 3);
+    EXPECT_EQ(rqm::next_prime(3), 5);
+    EXPECT_EQ(rqm::next_prime(1048575), 1048583);
+    EXPECT_EQ(rqm::next_prime(rqm::znum(1) << 64), (rqm::znum(1) << 64) + 13);
+    EXPECT_EQ(rqm::next_prime(pow(rqm::znum(10), 100)), pow(rqm::znum(10), 100) + 267);
+    EXPECT_EQ(rqm::next_prime((rqm::znum(1) << 127) - 2), (rqm::znum(1) << 127) - 1);
+}
+
 RC_GTEST_PROP(RQM_ZNUM, pre_increment, (int64_t ia))
 {
     rqm::znum a = ia;
@@ -350,6 +1009,206 @@ RC_GTEST_PROP(RQM_ZNUM, post_decrement, (int64_t ia))
     RC_ASSERT(b == ia);
 }
 
+RC_GTEST_PROP(RQM_ZNUM, compound_assignment, (int64_t ia, int64_t ib, uint8_t shift))
+{
+    // scale a up so we also exercise the heap-stored in-place paths
+    rqm::znum a = rqm::znum(ia) << shift;
+    rqm::znum b = ib;
+    rqm::znum c;
+
+    c = a;
+    c += b;
+    RC_ASSERT(c == a + b);
+    c = a;
+    c -= b;
+    RC_ASSERT(c == a - b);
+    c = a;
+    c *= b;
+    RC_ASSERT(c == a * b);
+    c = a;
+    c *= int32_t(ib);
+    RC_ASSERT(c == a * int32_t(ib));
+    c = a;
+    c <<= shift;
+    RC_ASSERT(c == a << shift);
+    c = a;
+    c >>= shift;
+    RC_ASSERT(c == a >> shift);
+    if(ib != 0)
+    {
+        c = a;
+        c /= b;
+        RC_ASSERT(c == a / b);
+        c = a;
+        c %= b;
+        RC_ASSERT(c == a % b);
+    }
+    if(int32_t(ib) != 0)
+    {
+        c = a;
+        c /= int32_t(ib);
+        RC_ASSERT(c == a / int32_t(ib));
+        c = a;
+        c %= int32_t(ib);
+        RC_ASSERT(c == a % int32_t(ib));
+    }
+}
+
+RC_GTEST_PROP(RQM_ZNUM, compound_assignment_self, (int64_t ia, uint8_t shift))
+{
+    rqm::znum a = rqm::znum(ia) << shift;
+    rqm::znum c;
+
+    c = a;
+    c += c;
+    RC_ASSERT(c == a + a);
+    c = a;
+    c -= c;
+    RC_ASSERT(c == 0);
+    c = a;
+    c *= c;
+    RC_ASSERT(c == a * a);
+    if(ia != 0)
+    {
+        c = a;
+        c /= c;
+        RC_ASSERT(c == 1);
+        c = a;
+        c %= c;
+        RC_ASSERT(c == 0);
+    }
+}
+
+RC_GTEST_PROP(RQM_ZNUM, temporary_operands, (int64_t ia, int64_t ib, int64_t ic, uint8_t shift))
+{
+    rqm::znum a = rqm::znum(ia) << shift;
+    rqm::znum b = ib;
+    rqm::znum c = ic;
+
+    // the same expressions, once with named intermediates and once with temporaries
+    rqm::znum ab = a * b;
+    rqm::znum bc = b * c;
+    rqm::znum ab_plus_bc = ab + bc;
+    RC_ASSERT(a * b + b * c - a == ab_plus_bc - a);
+    RC_ASSERT(a - (b * c) == a - bc);
+    RC_ASSERT((a + b) - (b + c) == (a + b) - bc + bc - (b + c));
+    RC_ASSERT(-(a * b) == -ab);
+    RC_ASSERT((a + b) * 3 == 3 * (a + b));
+    RC_ASSERT((a + b) * (b + c) == (b + c) * (a + b));
+    RC_ASSERT(((a + b) << 3) == (a + b) * 8);
+    RC_ASSERT(((a * 8) >> 3) == a);
+    RC_ASSERT((a + b) % 7 == (a + b) % rqm::znum(7));
+    if(ic != 0)
+    {
+        RC_ASSERT((a * c) / c == a);
+        RC_ASSERT((a * c + b) % c == (a * c + b) - ((a * c + b) / c) * c);
+    }
+}
+
+RC_GTEST_PROP(RQM_ZNUM, addmul_submul, (int64_t iacc, int64_t ia, int64_t ib, uint64_t ub, uint8_t shift_acc, uint8_t shift_a))
+{
+    rqm::znum acc0 = rqm::znum(iacc) << shift_acc;
+    rqm::znum a = rqm::znum(ia) << shift_a;
+    rqm::znum b = ib;
+    rqm::znum u = rqm::znum(int64_t(ub >> 1)) * 2 + int64_t(ub & 1);
+
+    rqm::znum acc = acc0;
+    addmul(acc, a, b);
+    RC_ASSERT(acc == acc0 + a * b);
+    acc = acc0;
+    submul(acc, a, b);
+    RC_ASSERT(acc == acc0 - a * b);
+    acc = acc0;
+    addmul_ui(acc, a, ub);
+    RC_ASSERT(acc == acc0 + a * u);
+    acc = acc0;
+    submul_ui(acc, a, ub);
+    RC_ASSERT(acc == acc0 - a * u);
+
+    // the accumulator doubling as an operand
+    acc = acc0;
+    addmul(acc, acc, b);
+    RC_ASSERT(acc == acc0 + acc0 * b);
+    acc = acc0;
+    submul(acc, a, acc);
+    RC_ASSERT(acc == acc0 - a * acc0);
+    acc = acc0;
+    submul(acc, acc, acc);
+    RC_ASSERT(acc == acc0 - acc0 * acc0);
+}
+
+TEST(RQM_ZNUM, addmul_cancellation)
+{
+    // results that cancel down to nothing, or to far fewer digits than the operands
+    rqm::znum a = (rqm::znum(1) << 500) + 12345;
+    rqm::znum b = (rqm::znum(1) << 300) - 1;
+    rqm::znum acc = a * b;
+    submul(acc, a, b);
+    EXPECT_EQ(acc, 0);
+    acc = a * b + 7;
+    submul(acc, b, a);
+    EXPECT_EQ(acc, 7);
+    acc = a * b - 7;
+    submul(acc, b, a);
+    EXPECT_EQ(acc, -7);
+    acc = -(a * b);
+    addmul(acc, a, b);
+    EXPECT_EQ(acc, 0);
+}
+
+TEST(RQM_ZNUM, accumulate_in_place)
+{
+    rqm::znum acc = 0;
+    rqm::znum term = rqm::znum(1) << 300;
+    for(int i = 0; i < 1000; ++i)
+    {
+        acc += term;
+        acc -= 1;
+    }
+    EXPECT_EQ(acc, term * 1000 - 1000);
+}
+
+TEST(RQM_ZNUM, reserve_and_shrink_to_fit)
+{
+    rqm::znum acc = 1;
+    acc.reserve(100);
+    EXPECT_GE(acc.capacity(), 100u);
+    EXPECT_EQ(acc, 1);
+
+    // accumulating into reserved storage should never need to grow it
+    uint32_t capacity = acc.capacity();
+    rqm::znum term = (rqm::znum(1) << 2000) - 1;
+    for(int i = 0; i < 100; ++i)
+    {
+        acc += term;
+    }
+    EXPECT_EQ(acc.capacity(), capacity);
+    EXPECT_EQ(acc, term * 100 + 1);
+
+    // assigning a smaller value keeps the storage around
+    acc = term;
+    EXPECT_EQ(acc.capacity(), capacity);
+    EXPECT_EQ(acc, term);
+
+    acc.shrink_to_fit();
+    EXPECT_LT(acc.capacity(), capacity);
+    EXPECT_GE(acc.capacity(), acc.n_digits());
+    EXPECT_EQ(acc, term);
+
+    acc = 7;
+    acc.shrink_to_fit();
+    EXPECT_EQ(acc, 7);
+}
+
+TEST(RQM_ZNUM, huge_temporaries)
+{
+    // the temporaries of the division here are far larger than a thread stack
+    rqm::znum a = (rqm::znum(1) << 100000000) + 5;
+    rqm::znum b = rqm::znum(1) << 40;
+    EXPECT_EQ(a % b, 5);
+    EXPECT_EQ(a % 7, 0); // 2^(3k+1) mod 7 = 2
+}
+
 template<typename T>
 T euclidean_gcd(T a, T b)
 {
@@ -0,0 +1,120 @@
+#include "rqm/znum_array.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+static std::vector<rqm::znum> sample_numbers()
+{
+    std::vector<rqm::znum> numbers;
+    numbers.push_back(rqm::znum(-5)); // a negative first element sets the sign bit of the first index entry
+    numbers.push_back(rqm::znum(0));
+    numbers.push_back(rqm::znum(1));
+    numbers.push_back(rqm::znum(-1));
+    numbers.push_back(rqm::znum(12345678901234567890ull));
+    numbers.push_back(-(rqm::znum(3) << 1000));
+    numbers.push_back(rqm::znum(0));
+    numbers.push_back(rqm::znum::from_string("123456789012345678901234567890123456789012345678901234567890"));
+    return numbers;
+}
+
+// the view needs 8-byte aligned data, which a std::string doesn't promise
+static std::vector<uint64_t> aligned_copy(const std::string &s)
+{
+    std::vector<uint64_t> buf((s.size() + 7) / 8);
+    memcpy(buf.data(), s.data(), s.size());
+    return buf;
+}
+
+TEST(RQM_ZNUM_ARRAY, roundtrip_in_memory)
+{
+    std::vector<rqm::znum> numbers = sample_numbers();
+    std::ostringstream os;
+    write_znum_array(os, numbers);
+    std::string s = os.str();
+    EXPECT_EQ(s.size(), rqm::znum_array_size(numbers));
+
+    std::vector<uint64_t> buf = aligned_copy(s);
+    rqm::znum_array_view array(reinterpret_cast<const std::byte *>(buf.data()), s.size());
+    ASSERT_EQ(array.size(), numbers.size());
+    for(size_t idx = 0; idx < numbers.size(); ++idx)
+    {
+        EXPECT_EQ(array[idx], numbers[idx]);
+    }
+    EXPECT_EQ(array[3] * array[4], numbers[3] * numbers[4]);
+    EXPECT_THROW(array[numbers.size()], std::out_of_range);
+}
+
+TEST(RQM_ZNUM_ARRAY, mapped_file)
+{
+    std::vector<rqm::znum> numbers = sample_numbers();
+    std::string path = testing::TempDir() + "rqm_znum_array_test.bin";
+    {
+        std::ofstream os(path, std::ios::binary);
+        write_znum_array(os, numbers);
+    }
+
+    rqm::mapped_znum_array mapped(path);
+    ASSERT_EQ(mapped.size(), numbers.size());
+    rqm::mapped_znum_array moved(std::move(mapped));
+    EXPECT_EQ(mapped.size(), 0u);
+    for(size_t idx = 0; idx < numbers.size(); ++idx)
+    {
+        EXPECT_EQ(moved[idx], numbers[idx]);
+        EXPECT_EQ(to_string(moved[idx]), to_string(numbers[idx]));
+    }
+    std::remove(path.c_str());
+
+    EXPECT_THROW(rqm::mapped_znum_array(testing::TempDir() + "rqm_no_such_file.bin"), std::system_error);
+}
+
+TEST(RQM_ZNUM_ARRAY, rejects_malformed)
+{
+    std::vector<rqm::znum> numbers = sample_numbers();
+    std::ostringstream os;
+    write_znum_array(os, numbers);
+    std::string s = os.str();
+
+    auto open = [](const std::string &data) {
+        std::vector<uint64_t> buf = aligned_copy(data);
+        rqm::znum_array_view array(reinterpret_cast<const std::byte *>(buf.data()), data.size());
+        for(size_t idx = 0; idx < array.size(); ++idx)
+        {
+            (void)array[idx];
+        }
+    };
+    EXPECT_NO_THROW(open(s));
+
+    // truncated
+    EXPECT_THROW(open(s.substr(0, s.size() - 4)), std::invalid_argument);
+    EXPECT_THROW(open(s.substr(0, 10)), std::invalid_argument);
+    // bad magic
+    std::string bad_magic = s;
+    bad_magic[0] = 'x';
+    EXPECT_THROW(open(bad_magic), std::invalid_argument);
+    // a count that runs past the end
+    std::string bad_count = s;
+    bad_count[15] = char(0x7f);
+    EXPECT_THROW(open(bad_count), std::invalid_argument);
+    // a leading zero digit in the last element
+    std::string bad_digit = s;
+    for(size_t idx = 0; idx < 4; ++idx)
+    {
+        bad_digit[s.size() - 1 - idx] = 0;
+    }
+    EXPECT_THROW(open(bad_digit), std::invalid_argument);
+    // a negative zero, in the second element
+    std::string negative_zero = s;
+    negative_zero[24] = char(negative_zero[24] | 1);
+    EXPECT_THROW(open(negative_zero), std::invalid_argument);
+    // a first element that doesn't start at the beginning of the pool
+    std::string bad_first_offset = s;
+    bad_first_offset[16] = char(bad_first_offset[16] | 4);
+    EXPECT_THROW(open(bad_first_offset), std::invalid_argument);
+}
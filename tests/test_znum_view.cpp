@@ -0,0 +1,74 @@
+#include "rqm/znum_view.h"
+
+#include <gtest/gtest.h>
+#include <rapidcheck/gtest.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+RC_GTEST_PROP(RQM_ZNUM_VIEW, arithmetic, (int64_t ia, int64_t ib, uint8_t shift))
+{
+    rqm::znum za = rqm::znum(ia) << shift;
+    rqm::znum zb = ib;
+    rqm::znum_view a = za;
+    rqm::znum_view b = zb;
+
+    RC_ASSERT(a + b == za + zb);
+    RC_ASSERT(a - b == za - zb);
+    RC_ASSERT(a * b == za * zb);
+    RC_ASSERT(-a == -za);
+    RC_ASSERT(abs(a) == abs(za));
+    RC_ASSERT(compare(a, b) == compare(za, zb));
+    RC_ASSERT((a < b) == (za < zb));
+    RC_ASSERT((a >= b) == (za >= zb));
+    RC_ASSERT((a == b) == (za == zb));
+    if(ib != 0)
+    {
+        RC_ASSERT(a / b == za / zb);
+        RC_ASSERT(a % b == za % zb);
+    }
+    RC_ASSERT(a.to_znum() == za);
+    RC_ASSERT(to_string(a) == to_string(za));
+    RC_ASSERT(to_string(a, 16) == to_string(za, 16));
+}
+
+TEST(RQM_ZNUM_VIEW, from_digits)
+{
+    static const rqm::digit_t digits[] = {0, 0, 1};
+    rqm::znum_view v(-1, digits, 3);
+    EXPECT_EQ(v, -(rqm::znum(1) << 64));
+    EXPECT_EQ(v.signum(), -1);
+    EXPECT_EQ(v.n_digits(), 3u);
+
+    std::ostringstream os;
+    os << v;
+    EXPECT_EQ(os.str(), "-18446744073709551616");
+
+    EXPECT_EQ(rqm::znum_view(), rqm::znum(0));
+    EXPECT_EQ(rqm::znum_view().to_znum(), 0); // no digits, and a null pointer for them
+    EXPECT_EQ(rqm::znum_view(1, digits, 0).signum(), 0);
+    EXPECT_THROW(v / rqm::znum_view(), std::out_of_range);
+}
+
+RC_GTEST_PROP(RQM_ZNUM_VIEW, hash, (int64_t ia, uint8_t shift))
+{
+    rqm::znum a = rqm::znum(ia) << shift;
+    rqm::znum b = rqm::znum::from_string(to_string(a));
+    RC_ASSERT(std::hash<rqm::znum>()(a) == std::hash<rqm::znum>()(b));
+    RC_ASSERT(std::hash<rqm::znum_view>()(a) == std::hash<rqm::znum>()(a));
+}
+
+TEST(RQM_ZNUM_VIEW, hash_distinguishes_sign)
+{
+    rqm::znum a = rqm::znum(1) << 100;
+    EXPECT_NE(std::hash<rqm::znum>()(a), std::hash<rqm::znum>()(-a));
+
+    std::unordered_set<rqm::znum> set;
+    for(int i = -1000; i <= 1000; ++i)
+    {
+        set.insert(rqm::znum(i) << 40);
+    }
+    EXPECT_EQ(set.size(), 2001u);
+    EXPECT_EQ(set.count(rqm::znum(-3) << 40), 1u);
+}